@@ -0,0 +1,186 @@
+#include "arena.h"
+#include <furi.h>
+
+#define ARENA_ALIGNMENT 8
+
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;
+    size_t used;
+    uint8_t data[];
+} ArenaBlock;
+
+struct Arena {
+    ArenaBlock* head;
+    size_t block_size;
+    size_t used;
+    size_t high_water;
+};
+
+typedef struct ArenaPoolChunk {
+    struct ArenaPoolChunk* next;
+} ArenaPoolChunk;
+
+typedef struct ArenaPoolItem {
+    struct ArenaPoolItem* next;
+} ArenaPoolItem;
+
+struct ArenaPool {
+    Arena* arena;
+    size_t item_size;
+    size_t chunk_items;
+    ArenaPoolChunk* chunks;
+    ArenaPoolItem* free_items;
+};
+
+static size_t arena_align(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static ArenaBlock* arena_block_alloc(size_t size) {
+    // leave room to align the first allocation in the block
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + size + ARENA_ALIGNMENT);
+    block->next = NULL;
+    block->size = size + ARENA_ALIGNMENT;
+    block->used = 0;
+    return block;
+}
+
+Arena* arena_alloc(size_t block_size) {
+    Arena* arena = malloc(sizeof(Arena));
+    arena->block_size = block_size;
+    arena->used = 0;
+    arena->high_water = 0;
+    arena->head = arena_block_alloc(block_size);
+    return arena;
+}
+
+void arena_free(Arena* arena) {
+    ArenaBlock* block = arena->head;
+    while(block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
+
+void* arena_push(Arena* arena, size_t size) {
+    ArenaBlock* block = arena->head;
+    uintptr_t start = (uintptr_t)block->data + block->used;
+    size_t padding = arena_align(start, ARENA_ALIGNMENT) - start;
+
+    if(block->used + padding + size > block->size) {
+        // current block is full, chain a new one in front of it
+        block = arena_block_alloc(MAX(arena->block_size, size));
+        block->next = arena->head;
+        arena->head = block;
+
+        start = (uintptr_t)block->data;
+        padding = arena_align(start, ARENA_ALIGNMENT) - start;
+    }
+
+    void* memory = block->data + block->used + padding;
+    block->used += padding + size;
+    arena->used += padding + size;
+    arena->high_water = MAX(arena->high_water, arena->used);
+
+    memset(memory, 0, size);
+    return memory;
+}
+
+void arena_reset(Arena* arena) {
+    if(arena->head->next) {
+        // contents did not fit in one block, replace the chain with a single block
+        // big enough for the high-water mark, so the next round needs no extra blocks
+        while(arena->head) {
+            ArenaBlock* next = arena->head->next;
+            free(arena->head);
+            arena->head = next;
+        }
+        arena->block_size = MAX(arena->block_size, arena->high_water);
+        arena->head = arena_block_alloc(arena->block_size);
+    }
+    arena->head->used = 0;
+    arena->used = 0;
+}
+
+size_t arena_used_get(const Arena* arena) {
+    return arena->used;
+}
+
+size_t arena_high_water_get(const Arena* arena) {
+    return arena->high_water;
+}
+
+ArenaMark arena_mark(const Arena* arena) {
+    return (ArenaMark){
+        .block = arena->head,
+        .block_used = arena->head->used,
+        .used = arena->used,
+    };
+}
+
+void arena_rewind(Arena* arena, ArenaMark mark) {
+    // drop blocks chained after the mark was taken
+    while(arena->head != mark.block) {
+        furi_check(arena->head->next, "Arena mark is not from this arena");
+        ArenaBlock* next = arena->head->next;
+        free(arena->head);
+        arena->head = next;
+    }
+    arena->head->used = mark.block_used;
+    arena->used = mark.used;
+}
+
+ArenaPool* arena_pool_alloc(Arena* arena, size_t item_size, size_t chunk_items) {
+    furi_check(chunk_items > 0);
+
+    ArenaPool* pool = arena_push(arena, sizeof(ArenaPool));
+    pool->arena = arena;
+    pool->item_size = arena_align(MAX(item_size, sizeof(ArenaPoolItem)), ARENA_ALIGNMENT);
+    pool->chunk_items = chunk_items;
+    pool->chunks = NULL;
+    pool->free_items = NULL;
+    return pool;
+}
+
+static void arena_pool_chunk_release(ArenaPool* pool, ArenaPoolChunk* chunk) {
+    uint8_t* items = (uint8_t*)chunk + arena_align(sizeof(ArenaPoolChunk), ARENA_ALIGNMENT);
+    for(size_t i = 0; i < pool->chunk_items; i++) {
+        ArenaPoolItem* item = (ArenaPoolItem*)(items + i * pool->item_size);
+        item->next = pool->free_items;
+        pool->free_items = item;
+    }
+}
+
+void* arena_pool_get(ArenaPool* pool) {
+    if(!pool->free_items) {
+        ArenaPoolChunk* chunk = arena_push(
+            pool->arena,
+            arena_align(sizeof(ArenaPoolChunk), ARENA_ALIGNMENT) +
+                pool->item_size * pool->chunk_items);
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        arena_pool_chunk_release(pool, chunk);
+    }
+
+    ArenaPoolItem* item = pool->free_items;
+    pool->free_items = item->next;
+
+    memset(item, 0, pool->item_size);
+    return item;
+}
+
+void arena_pool_put(ArenaPool* pool, void* item) {
+    ArenaPoolItem* free_item = item;
+    free_item->next = pool->free_items;
+    pool->free_items = free_item;
+}
+
+void arena_pool_reset(ArenaPool* pool) {
+    pool->free_items = NULL;
+    for(ArenaPoolChunk* chunk = pool->chunks; chunk; chunk = chunk->next) {
+        arena_pool_chunk_release(pool, chunk);
+    }
+}
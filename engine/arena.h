@@ -0,0 +1,97 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Arena Arena;
+
+typedef struct ArenaPool ArenaPool;
+
+typedef struct {
+    void* block;
+    size_t block_used;
+    size_t used;
+} ArenaMark;
+
+/** Arena allocator
+ * Memory is handed out by bumping a pointer inside big blocks and released all at once
+ * @param block_size size of the blocks requested from the heap
+ * @return Arena*  Arena instance
+ */
+Arena* arena_alloc(size_t block_size);
+
+/** Free the arena and everything allocated from it
+ * @param arena Arena instance
+ */
+void arena_free(Arena* arena);
+
+/** Allocate zeroed memory from the arena
+ * Memory is aligned to 8 bytes and stays valid until the arena is reset or freed
+ * @param arena Arena instance
+ * @param size  size in bytes
+ * @return void*  allocated memory
+ */
+void* arena_push(Arena* arena, size_t size);
+
+/** Release everything allocated from the arena, keeping the first block for reuse
+ * @param arena Arena instance
+ */
+void arena_reset(Arena* arena);
+
+/** Get the number of bytes currently allocated from the arena
+ * @param arena Arena instance
+ * @return size_t  used bytes
+ */
+size_t arena_used_get(const Arena* arena);
+
+/** Get the largest number of bytes the arena has held at once
+ * @param arena Arena instance
+ * @return size_t  high-water mark in bytes
+ */
+size_t arena_high_water_get(const Arena* arena);
+
+/** Remember the current allocation point
+ * @param arena Arena instance
+ * @return ArenaMark  mark to rewind to
+ */
+ArenaMark arena_mark(const Arena* arena);
+
+/** Release everything allocated after the mark
+ * Allows scoped temporaries inside a longer lived arena
+ * @param arena Arena instance
+ * @param mark  mark from arena_mark
+ */
+void arena_rewind(Arena* arena, ArenaMark mark);
+
+/** Fixed size pool that lives inside an arena
+ * Items can be returned one by one and are reused by the next allocation
+ * @param arena arena to take memory from
+ * @param item_size size of one item
+ * @param chunk_items number of items requested from the arena at once
+ * @return ArenaPool*  ArenaPool instance, freed together with the arena
+ */
+ArenaPool* arena_pool_alloc(Arena* arena, size_t item_size, size_t chunk_items);
+
+/** Get a zeroed item from the pool
+ * @param pool ArenaPool instance
+ * @return void*  item
+ */
+void* arena_pool_get(ArenaPool* pool);
+
+/** Return an item to the pool
+ * @param pool ArenaPool instance
+ * @param item item from arena_pool_get
+ */
+void arena_pool_put(ArenaPool* pool, void* item);
+
+/** Return every item to the pool at once
+ * @param pool ArenaPool instance
+ */
+void arena_pool_reset(ArenaPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,30 +1,28 @@
 #include <furi.h>
+#include <stdio.h>
 #include "canvas.h"
 
+// the screen is 128px wide, longer strings would not fit anyway
+#define CANVAS_PRINTF_BUFFER_SIZE 64
+
 void canvas_printf(Canvas* canvas, uint8_t x, uint8_t y, const char* format, ...) {
-    FuriString* string = furi_string_alloc();
+    char string[CANVAS_PRINTF_BUFFER_SIZE];
     va_list args;
     va_start(args, format);
-    furi_string_vprintf(string, format, args);
+    vsnprintf(string, sizeof(string), format, args);
     va_end(args);
 
-    canvas_draw_str(canvas, x, y, furi_string_get_cstr(string));
-
-    furi_string_free(string);
+    canvas_draw_str(canvas, x, y, string);
 }
 
 size_t canvas_printf_width(Canvas* canvas, const char* format, ...) {
-    FuriString* string = furi_string_alloc();
+    char string[CANVAS_PRINTF_BUFFER_SIZE];
     va_list args;
     va_start(args, format);
-    furi_string_vprintf(string, format, args);
+    vsnprintf(string, sizeof(string), format, args);
     va_end(args);
 
-    size_t size = canvas_string_width(canvas, furi_string_get_cstr(string));
-
-    furi_string_free(string);
-
-    return size;
+    return canvas_string_width(canvas, string);
 }
 
 void canvas_printf_aligned(
@@ -35,15 +33,13 @@ void canvas_printf_aligned(
     Align v,
     const char* format,
     ...) {
-    FuriString* string = furi_string_alloc();
+    char string[CANVAS_PRINTF_BUFFER_SIZE];
     va_list args;
     va_start(args, format);
-    furi_string_vprintf(string, format, args);
+    vsnprintf(string, sizeof(string), format, args);
     va_end(args);
 
-    canvas_draw_str_aligned(canvas, x, y, h, v, furi_string_get_cstr(string));
-
-    furi_string_free(string);
+    canvas_draw_str_aligned(canvas, x, y, h, v, string);
 }
 
 void canvas_draw_str_aligned_outline(
@@ -1,5 +1,6 @@
 #include "clock_timer.h"
 #include <stdlib.h>
+#include <furi.h>
 
 #include <furi_hal_interrupt.h>
 #include <furi_hal_bus.h>
@@ -9,27 +10,21 @@
 #define FURI_HAL_CLOCK_TIMER_BUS FuriHalBusTIM2
 #define FURI_HAL_CLOCK_TIMER_IRQ FuriHalInterruptIdTIM2
 
-typedef struct {
-    ClockTimerCallback callback;
-    void* context;
-} ClockTimer;
-
-static ClockTimer clock_timer = {
-    .callback = NULL,
-    .context = NULL,
-};
-
 static void clock_timer_isr(void* context) {
-    if(clock_timer.callback) {
-        clock_timer.callback(context);
+    ClockTimer* timer = context;
+    if(timer->callback) {
+        timer->callback(timer->context);
     }
 
     LL_TIM_ClearFlag_UPDATE(FURI_HAL_CLOCK_TIMER);
 }
 
-void clock_timer_start(ClockTimerCallback callback, void* context, float period) {
-    clock_timer.callback = callback;
-    clock_timer.context = context;
+void clock_timer_start(ClockTimer* timer, ClockTimerCallback callback, void* context, float period) {
+    furi_check(
+        !furi_hal_bus_is_enabled(FURI_HAL_CLOCK_TIMER_BUS), "Clock timer is already running");
+
+    timer->callback = callback;
+    timer->context = context;
 
     furi_hal_bus_enable(FURI_HAL_CLOCK_TIMER_BUS);
 
@@ -38,16 +33,19 @@ void clock_timer_start(ClockTimerCallback callback, void* context, float period)
     TIM_InitStruct.Autoreload = (SystemCoreClock / period) - 1;
     LL_TIM_Init(FURI_HAL_CLOCK_TIMER, &TIM_InitStruct);
 
-    furi_hal_interrupt_set_isr(FURI_HAL_CLOCK_TIMER_IRQ, clock_timer_isr, clock_timer.context);
+    furi_hal_interrupt_set_isr(FURI_HAL_CLOCK_TIMER_IRQ, clock_timer_isr, timer);
 
     LL_TIM_EnableIT_UPDATE(FURI_HAL_CLOCK_TIMER);
     LL_TIM_EnableCounter(FURI_HAL_CLOCK_TIMER);
 }
 
-void clock_timer_stop(void) {
+void clock_timer_stop(ClockTimer* timer) {
     LL_TIM_DisableIT_UPDATE(FURI_HAL_CLOCK_TIMER);
     LL_TIM_DisableCounter(FURI_HAL_CLOCK_TIMER);
 
     furi_hal_bus_disable(FURI_HAL_CLOCK_TIMER_BUS);
     furi_hal_interrupt_set_isr(FURI_HAL_CLOCK_TIMER_IRQ, NULL, NULL);
+
+    timer->callback = NULL;
+    timer->context = NULL;
 }
\ No newline at end of file
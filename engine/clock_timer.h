@@ -1,4 +1,5 @@
 #pragma once
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -6,10 +7,26 @@ extern "C" {
 
 typedef void (*ClockTimerCallback)(void* context);
 
-void clock_timer_start(ClockTimerCallback callback, void* context, float period);
+/** Clock timer state, owned by the caller and handed to the interrupt as its context */
+typedef struct {
+    ClockTimerCallback callback;
+    void* context;
+} ClockTimer;
 
-void clock_timer_stop(void);
+/** Start the hardware timer
+ * There is a single hardware timer, starting a second one while it runs is an error
+ * @param timer timer state, must stay valid until clock_timer_stop
+ * @param callback callback, called from the interrupt
+ * @param context callback context
+ * @param period timer frequency in Hz
+ */
+void clock_timer_start(ClockTimer* timer, ClockTimerCallback callback, void* context, float period);
+
+/** Stop the hardware timer
+ * @param timer timer state
+ */
+void clock_timer_stop(ClockTimer* timer);
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,117 @@
+#pragma once
+#include <stdint.h>
+#include "entity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Stackless coroutines for entity scripts, in the style of protothreads.
+ *
+ * A coroutine is a function that returns whenever it waits and continues after
+ * the wait the next time it is called. Start it with level_coroutine_start, the
+ * level resumes it when the wait is over and costs nothing while it waits.
+ *
+ *   static void ping_script(Coroutine* co, Entity* self, GameManager* manager, void* context) {
+ *       PingContext* ping = context;
+ *       COROUTINE_BEGIN(co);
+ *       for(ping->radius = 0; ping->radius < 40; ping->radius += 2) {
+ *           COROUTINE_WAIT_MS(co, 50);
+ *       }
+ *       COROUTINE_END(co);
+ *   }
+ *
+ * Local variables are lost at every wait, keep state in the entity context.
+ * A switch statement cannot span a wait, and only one wait fits on a line.
+ */
+
+typedef enum {
+    CoroutineWaitNone,
+    CoroutineWaitFrames, // resumed after `arg` level updates
+    CoroutineWaitMs, // resumed after `arg` milliseconds
+    CoroutineWaitEvent, // resumed when an event of type `arg` is published on the level
+    CoroutineWaitCondition, // resumed every level update to check its condition
+    CoroutineWaitDone, // finished
+} CoroutineWait;
+
+/** Coroutine id, stays unique after the coroutine is gone, 0 is never a valid coroutine */
+typedef uint32_t CoroutineId;
+
+#define COROUTINE_ID_NONE 0
+
+typedef struct {
+    CoroutineId id; // for level_coroutine_stop, also from inside the coroutine
+    uint16_t line; // resume point
+    uint8_t wait; // CoroutineWait
+    uint32_t arg; // wait argument
+    EntityEventValue event; // value of the event that ended a CoroutineWaitEvent
+} Coroutine;
+
+typedef void (*CoroutineCallback)(Coroutine* co, Entity* self, GameManager* manager, void* context);
+
+#define COROUTINE_BEGIN(co)    \
+    switch((co)->line) {       \
+    case 0:
+
+#define COROUTINE_END(co)                  \
+    }                                      \
+    (co)->line = 0;                        \
+    (co)->wait = CoroutineWaitDone;        \
+    return
+
+#define COROUTINE_WAIT_SET(co, type, value) \
+    (co)->wait = (type);                    \
+    (co)->arg = (value);                    \
+    (co)->line = __LINE__
+
+/** Wait for a number of level updates, at least 1 */
+#define COROUTINE_WAIT_FRAMES(co, frames)                          \
+    do {                                                           \
+        COROUTINE_WAIT_SET(co, CoroutineWaitFrames, (frames));     \
+        return;                                                    \
+    case __LINE__:;                                                \
+    } while(0)
+
+/** Wait until the next level update */
+#define COROUTINE_YIELD(co) COROUTINE_WAIT_FRAMES(co, 1)
+
+/** Wait for a number of milliseconds */
+#define COROUTINE_WAIT_MS(co, ms)                          \
+    do {                                                   \
+        COROUTINE_WAIT_SET(co, CoroutineWaitMs, (ms));     \
+        return;                                            \
+    case __LINE__:;                                        \
+    } while(0)
+
+/** Wait for an event published on the level bus, its value ends up in co->event */
+#define COROUTINE_WAIT_EVENT(co, type)                          \
+    do {                                                        \
+        COROUTINE_WAIT_SET(co, CoroutineWaitEvent, (type));     \
+        return;                                                 \
+    case __LINE__:;                                             \
+    } while(0)
+
+/** Wait until the condition is true, it is checked once per level update */
+#define COROUTINE_WAIT_UNTIL(co, condition)        \
+    do {                                           \
+        (co)->line = __LINE__;                     \
+        __attribute__((fallthrough));              \
+    case __LINE__:                                 \
+        if(!(condition)) {                         \
+            (co)->wait = CoroutineWaitCondition;   \
+            return;                                \
+        }                                          \
+    } while(0)
+
+/** Finish the coroutine */
+#define COROUTINE_EXIT(co)              \
+    do {                                \
+        (co)->line = 0;                 \
+        (co)->wait = CoroutineWaitDone; \
+        return;                         \
+    } while(0)
+
+#ifdef __cplusplus
+}
+#endif
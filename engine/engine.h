@@ -4,6 +4,9 @@
 #include "level.h"
 #include "entity.h"
 #include "game_manager.h"
+#include "fixed.h"
+#include "rng.h"
+#include "job.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,10 +19,19 @@ typedef struct {
     void (*start)(GameManager* game_manager, void* context);
     void (*stop)(void* context);
     size_t context_size;
+    const EntityRegistry* entity_registry; // optional, static dispatch of entity callbacks
 } Game;
 
+/** The game the app entry point runs, defined by the game */
 extern const Game game;
 
+/** Run a game until it stops, with its own GameManager and GameEngine
+ * Everything the run needs hangs off these instances, the app entry point only picks `game`
+ * @param game game to run
+ * @return int32_t  0 on success, -1 if entities leaked
+ */
+int32_t game_run(const Game* game);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
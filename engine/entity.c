@@ -10,31 +10,27 @@
 #define ENTITY_D(...)
 #endif
 
-static int32_t entities_count = 0;
-
-int32_t entities_get_count(void) {
-    return entities_count;
-}
-
-Entity* entity_alloc(const EntityDescription* description) {
-    entities_count++;
-    Entity* entity = malloc(sizeof(Entity));
+void entity_init(Entity* entity, const EntityDescription* description, void* context) {
     entity->position = VECTOR_ZERO;
     entity->description = description;
-    entity->context = NULL;
-    if(description && description->context_size > 0) {
-        entity->context = malloc(description->context_size);
-    }
+    entity->context = context;
     entity->collider = NULL;
     entity->collider_offset = VECTOR_ZERO;
-    ENTITY_D("Allocated at %p", entity);
+    ENTITY_D("Initialized at %p", entity);
     entity->collider_dirty = false;
-    return entity;
+    entity->subscriptions = 0;
+    entity->timers = 0;
+    entity->coroutines = 0;
+    entity->removed = false;
+    entity->update_bucket = 0;
+    entity->update_due = true;
+    entity->update_delta = 0;
+    entity->update_pending = 0;
 }
 
 void entity_collider_add_circle(Entity* entity, float radius) {
     furi_check(entity->collider == NULL, "Collider already added");
-    entity->collider = malloc(sizeof(Collider));
+    entity->collider = &entity->collider_data;
     entity->collider->type = ColliderTypeCircle;
     entity->collider->circle.radius = radius;
     entity->collider_dirty = true;
@@ -42,7 +38,7 @@ void entity_collider_add_circle(Entity* entity, float radius) {
 
 void entity_collider_add_rect(Entity* entity, float width, float height) {
     furi_check(entity->collider == NULL, "Collider already added");
-    entity->collider = malloc(sizeof(Collider));
+    entity->collider = &entity->collider_data;
     entity->collider->type = ColliderTypeRect;
     entity->collider->rect.half_width = width / 2;
     entity->collider->rect.half_height = height / 2;
@@ -51,7 +47,6 @@ void entity_collider_add_rect(Entity* entity, float width, float height) {
 
 void entity_collider_remove(Entity* entity) {
     furi_check(entity->collider != NULL, "Collider not added");
-    free(entity->collider);
     entity->collider = NULL;
     entity->collider_dirty = false;
 }
@@ -72,16 +67,9 @@ static Vector entity_collider_position_get(Entity* entity) {
     };
 }
 
-void entity_free(Entity* entity) {
-    entities_count--;
-    ENTITY_D("Freeing at %p", entity);
-    if(entity->context) {
-        free(entity->context);
-    }
-    if(entity->collider) {
-        free(entity->collider);
-    }
-    free(entity);
+void entity_deinit(Entity* entity) {
+    ENTITY_D("Deinitialized at %p", entity);
+    entity->collider = NULL;
 }
 
 const EntityDescription* entity_description_get(Entity* entity) {
@@ -101,6 +89,14 @@ void* entity_context_get(Entity* entity) {
     return entity->context;
 }
 
+float entity_update_delta_get(Entity* entity) {
+    return entity->update_delta;
+}
+
+bool entity_update_due(Entity* entity) {
+    return entity->update_due;
+}
+
 void entity_call_start(Entity* entity, GameManager* manager) {
     if(entity->description && entity->description->start) {
         entity->description->start(entity, manager, entity->context);
@@ -136,7 +132,8 @@ bool entity_collider_circle_circle(Entity* entity, Entity* other) {
     Vector pos2 = entity_collider_position_get(other);
 
     Vector delta = vector_sub(pos1, pos2);
-    return vector_length(delta) < entity->collider->circle.radius + other->collider->circle.radius;
+    float radius = entity->collider->circle.radius + other->collider->circle.radius;
+    return vector_length_sq(delta) < radius * radius;
 }
 
 bool entity_collider_rect_rect(Entity* entity, Entity* other) {
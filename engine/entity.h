@@ -33,8 +33,16 @@ typedef struct {
     void (*collision)(Entity* self, Entity* other, GameManager* manager, void* context);
     void (*event)(Entity* self, GameManager* manager, EntityEvent event, void* context);
     size_t context_size;
+    bool update_lod; // expensive update steps less often far from the focus, see entity_update_due
 } EntityDescription;
 
+/** Statically dispatched entity callbacks, see entity_registry.h */
+typedef struct {
+    void (*update)(Entity* const* entities, size_t count, GameManager* manager);
+    void (*render)(Entity* const* entities, size_t count, GameManager* manager, Canvas* canvas);
+    void (*collision)(Entity* self, Entity* other, GameManager* manager);
+} EntityRegistry;
+
 const EntityDescription* entity_description_get(Entity* entity);
 
 Vector entity_pos_get(Entity* entity);
@@ -43,6 +51,18 @@ void entity_pos_set(Entity* entity, Vector position);
 
 void* entity_context_get(Entity* entity);
 
+/** Time covered by the running update in seconds
+ * For update_lod entities it is the time since the last due update, and 0 when this one is not due
+ */
+float entity_update_delta_get(Entity* entity);
+
+/** Check if the expensive part of the running update is due
+ * Always true unless the description sets update_lod, then it is true every frame near the
+ * level's update focus and less often further away. Cheap per frame work, like placing the
+ * entity on screen, should run either way.
+ */
+bool entity_update_due(Entity* entity);
+
 void entity_collider_add_circle(Entity* entity, float radius);
 
 void entity_collider_add_rect(Entity* entity, float width, float height);
@@ -29,13 +29,22 @@ struct Entity {
     const EntityDescription* description;
     void* context;
     Collider* collider;
+    Collider collider_data;
     Vector collider_offset;
     bool collider_dirty;
+    uint16_t subscriptions;
+    uint16_t timers;
+    uint16_t coroutines;
+    bool removed;
+    uint8_t update_bucket; // frame slot within an update level of detail period
+    bool update_due; // the level of detail step runs in the current update
+    float update_delta; // time covered by the current update, 0 when it is not due
+    float update_pending; // time since the last update
 };
 
-Entity* entity_alloc(const EntityDescription* behaviour);
+void entity_init(Entity* entity, const EntityDescription* description, void* context);
 
-void entity_free(Entity* entity);
+void entity_deinit(Entity* entity);
 
 void entity_call_start(Entity* entity, GameManager* manager);
 
@@ -51,8 +60,6 @@ bool entity_collider_check_collision(Entity* entity, Entity* other);
 
 bool entity_collider_exists(Entity* entity);
 
-int32_t entities_get_count(void);
-
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include "entity_i.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Static dispatch for entity callbacks, opt-in.
+ *
+ * List the game's entity descriptions in an X-macro, after they are defined, and
+ * generate the registry in the same file:
+ *
+ *   #define GAME_ENTITIES(X) X(submarine_desc) X(torpedo_desc)
+ *   ENTITY_REGISTRY_DEFINE(game_entities, GAME_ENTITIES)
+ *
+ * then set `.entity_registry = &game_entities` in the Game.
+ *
+ * The generated loops compare descriptions by address and call the callbacks
+ * directly, the descriptions are constant, so the compiler can drop missing
+ * callbacks and inline small ones. Entities with a description that is not
+ * listed still go through the regular indirect call.
+ */
+
+#define ENTITY_REGISTRY_UPDATE_CASE(desc)                        \
+    if(description == &desc) {                                   \
+        if(desc.update) desc.update(entity, manager, entity->context); \
+        continue;                                                \
+    }
+
+#define ENTITY_REGISTRY_RENDER_CASE(desc)                                \
+    if(description == &desc) {                                           \
+        if(desc.render) desc.render(entity, manager, canvas, entity->context); \
+        continue;                                                        \
+    }
+
+#define ENTITY_REGISTRY_COLLISION_CASE(desc)                               \
+    if(description == &desc) {                                             \
+        if(desc.collision) desc.collision(self, other, manager, self->context); \
+        return;                                                            \
+    }
+
+#define ENTITY_REGISTRY_DEFINE(name, LIST)                                                \
+    static void name##_update(Entity* const* entities, size_t count, GameManager* manager) { \
+        for(size_t i = 0; i < count; i++) {                                               \
+            Entity* entity = entities[i];                                                 \
+            const EntityDescription* description = entity->description;                   \
+            LIST(ENTITY_REGISTRY_UPDATE_CASE)                                             \
+            entity_call_update(entity, manager);                                          \
+        }                                                                                 \
+    }                                                                                     \
+                                                                                          \
+    static void name##_render(                                                            \
+        Entity* const* entities, size_t count, GameManager* manager, Canvas* canvas) {    \
+        for(size_t i = 0; i < count; i++) {                                               \
+            Entity* entity = entities[i];                                                 \
+            const EntityDescription* description = entity->description;                   \
+            LIST(ENTITY_REGISTRY_RENDER_CASE)                                             \
+            entity_call_render(entity, manager, canvas);                                  \
+        }                                                                                 \
+    }                                                                                     \
+                                                                                          \
+    static void name##_collision(Entity* self, Entity* other, GameManager* manager) {     \
+        const EntityDescription* description = self->description;                         \
+        LIST(ENTITY_REGISTRY_COLLISION_CASE)                                              \
+        entity_call_collision(self, other, manager);                                      \
+    }                                                                                     \
+                                                                                          \
+    static const EntityRegistry name = {                                                  \
+        .update = name##_update,                                                          \
+        .render = name##_render,                                                          \
+        .collision = name##_collision,                                                    \
+    };
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,154 @@
+#include "fixed.h"
+
+// sin() of the first quarter turn in Q16.16, 256 steps plus the end point,
+// the other three quarters are mirrored from it
+static const int32_t fixed_sin_table[FIXED_SIN_TABLE_QUARTER + 1] = {
+    0, 402, 804, 1206, 1608, 2010, 2412, 2814,
+    3216, 3617, 4019, 4420, 4821, 5222, 5623, 6023,
+    6424, 6824, 7224, 7623, 8022, 8421, 8820, 9218,
+    9616, 10014, 10411, 10808, 11204, 11600, 11996, 12391,
+    12785, 13180, 13573, 13966, 14359, 14751, 15143, 15534,
+    15924, 16314, 16703, 17091, 17479, 17867, 18253, 18639,
+    19024, 19409, 19792, 20175, 20557, 20939, 21320, 21699,
+    22078, 22457, 22834, 23210, 23586, 23961, 24335, 24708,
+    25080, 25451, 25821, 26190, 26558, 26925, 27291, 27656,
+    28020, 28383, 28745, 29106, 29466, 29824, 30182, 30538,
+    30893, 31248, 31600, 31952, 32303, 32652, 33000, 33347,
+    33692, 34037, 34380, 34721, 35062, 35401, 35738, 36075,
+    36410, 36744, 37076, 37407, 37736, 38064, 38391, 38716,
+    39040, 39362, 39683, 40002, 40320, 40636, 40951, 41264,
+    41576, 41886, 42194, 42501, 42806, 43110, 43412, 43713,
+    44011, 44308, 44604, 44898, 45190, 45480, 45769, 46056,
+    46341, 46624, 46906, 47186, 47464, 47741, 48015, 48288,
+    48559, 48828, 49095, 49361, 49624, 49886, 50146, 50404,
+    50660, 50914, 51166, 51417, 51665, 51911, 52156, 52398,
+    52639, 52878, 53114, 53349, 53581, 53812, 54040, 54267,
+    54491, 54714, 54934, 55152, 55368, 55582, 55794, 56004,
+    56212, 56418, 56621, 56823, 57022, 57219, 57414, 57607,
+    57798, 57986, 58172, 58356, 58538, 58718, 58896, 59071,
+    59244, 59415, 59583, 59750, 59914, 60075, 60235, 60392,
+    60547, 60700, 60851, 60999, 61145, 61288, 61429, 61568,
+    61705, 61839, 61971, 62101, 62228, 62353, 62476, 62596,
+    62714, 62830, 62943, 63054, 63162, 63268, 63372, 63473,
+    63572, 63668, 63763, 63854, 63944, 64031, 64115, 64197,
+    64277, 64354, 64429, 64501, 64571, 64639, 64704, 64766,
+    64827, 64884, 64940, 64993, 65043, 65091, 65137, 65180,
+    65220, 65259, 65294, 65328, 65358, 65387, 65413, 65436,
+    65457, 65476, 65492, 65505, 65516, 65525, 65531, 65535,
+    65536,
+};
+
+static int32_t fixed_sin_sample(uint32_t index) {
+    uint32_t quadrant = (index / FIXED_SIN_TABLE_QUARTER) & 3;
+    uint32_t offset = index % FIXED_SIN_TABLE_QUARTER;
+
+    switch(quadrant) {
+    case 0:
+        return fixed_sin_table[offset];
+    case 1:
+        return fixed_sin_table[FIXED_SIN_TABLE_QUARTER - offset];
+    case 2:
+        return -fixed_sin_table[offset];
+    default:
+        return -fixed_sin_table[FIXED_SIN_TABLE_QUARTER - offset];
+    }
+}
+
+static Fixed fixed_sin_phase(uint32_t phase) {
+    // 16 bit phase: 10 bits of table index, 6 bits to interpolate between entries
+    uint32_t index = (phase & 0xFFFF) >> FIXED_SIN_FRACTION_BITS;
+    int32_t fraction = phase & ((1 << FIXED_SIN_FRACTION_BITS) - 1);
+
+    int32_t a = fixed_sin_sample(index);
+    int32_t b = fixed_sin_sample(index + 1);
+    return a + (((b - a) * fraction) >> FIXED_SIN_FRACTION_BITS);
+}
+
+Fixed fixed_sin(Fixed turns) {
+    // only the fraction of the turn matters, wrapping is free
+    return fixed_sin_phase((uint32_t)turns);
+}
+
+Fixed fixed_cos(Fixed turns) {
+    return fixed_sin_phase((uint32_t)turns + FIXED_ONE / 4);
+}
+
+float fixed_sinf(float turns) {
+    return fixed_to_float(fixed_sin(fixed_from_float(turns)));
+}
+
+float fixed_cosf(float turns) {
+    return fixed_to_float(fixed_cos(fixed_from_float(turns)));
+}
+
+Fixed fixed_atan2(Fixed y, Fixed x) {
+    if(x == 0 && y == 0) {
+        return 0;
+    }
+
+    int64_t abs_x = x < 0 ? -(int64_t)x : x;
+    int64_t abs_y = y < 0 ? -(int64_t)y : y;
+
+    // reduce to the first octant, z in [0, 1]
+    bool swap = abs_y > abs_x;
+    int64_t num = swap ? abs_x : abs_y;
+    int64_t den = swap ? abs_y : abs_x;
+    Fixed z = (Fixed)((num << FIXED_SHIFT) / den);
+
+    // atan(z) ~= pi/4 * z + 0.273 * z * (1 - z), in turns, max error ~0.0006 turn
+    Fixed turns = fixed_mul(z, FIXED_ONE / 8 + fixed_mul(FIXED_ATAN_K, FIXED_ONE - z));
+
+    if(swap) turns = FIXED_ONE / 4 - turns;
+    if(x < 0) turns = FIXED_ONE / 2 - turns;
+    if(y < 0) turns = -turns;
+    return turns;
+}
+
+static uint32_t fixed_isqrt64(uint64_t value) {
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while(bit > value) {
+        bit >>= 2;
+    }
+
+    while(bit) {
+        if(value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+Fixed fixed_sqrt(Fixed value) {
+    if(value <= 0) {
+        return 0;
+    }
+    return (Fixed)fixed_isqrt64((uint64_t)value << FIXED_SHIFT);
+}
+
+Fixed fixed_vector_length(FixedVector v) {
+    // squares are Q32.32, their root is Q16.16 again
+    uint64_t squared = (uint64_t)((int64_t)v.x * v.x) + (uint64_t)((int64_t)v.y * v.y);
+    return (Fixed)fixed_isqrt64(squared);
+}
+
+FixedVector fixed_vector_rotate(FixedVector v, Fixed turns) {
+    Fixed c = fixed_cos(turns);
+    Fixed s = fixed_sin(turns);
+    return (FixedVector){
+        .x = fixed_mul(v.x, c) - fixed_mul(v.y, s),
+        .y = fixed_mul(v.x, s) + fixed_mul(v.y, c),
+    };
+}
+
+FixedVector fixed_vector_from_turn(Fixed turns) {
+    return (FixedVector){
+        .x = fixed_cos(turns),
+        .y = fixed_sin(turns),
+    };
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "vector.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Q16.16 fixed point numbers.
+ * Angles are measured in turns, FIXED_ONE is a full circle, same as the float
+ * headings used by games. Trigonometry is a table read, so results are the same
+ * on every platform.
+ */
+typedef int32_t Fixed;
+
+typedef struct {
+    Fixed x;
+    Fixed y;
+} FixedVector;
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT)
+#define FIXED_HALF (FIXED_ONE / 2)
+
+#define FIXED_SIN_TABLE_SIZE 1024 // table steps per turn
+#define FIXED_SIN_TABLE_QUARTER (FIXED_SIN_TABLE_SIZE / 4)
+#define FIXED_SIN_FRACTION_BITS 6 // 16 bit phase = 10 bit index + 6 bit fraction
+
+#define FIXED_ATAN_K 2847 // 0.273 / (2 * pi) in Q16.16
+
+#define FIXED_VECTOR_ZERO ((FixedVector){0, 0})
+
+static inline Fixed fixed_from_int(int32_t value) {
+    return value * FIXED_ONE;
+}
+
+static inline int32_t fixed_to_int(Fixed value) {
+    return value >> FIXED_SHIFT;
+}
+
+static inline Fixed fixed_from_float(float value) {
+    return (Fixed)(value * (float)FIXED_ONE);
+}
+
+static inline float fixed_to_float(Fixed value) {
+    return (float)value * (1.0f / (float)FIXED_ONE);
+}
+
+static inline Fixed fixed_mul(Fixed a, Fixed b) {
+    return (Fixed)(((int64_t)a * b) >> FIXED_SHIFT);
+}
+
+static inline Fixed fixed_div(Fixed a, Fixed b) {
+    return (Fixed)(((int64_t)a * FIXED_ONE) / b);
+}
+
+/** Square root
+ * @param value Q16.16 value, negative values give 0
+ * @return Fixed  square root
+ */
+Fixed fixed_sqrt(Fixed value);
+
+/** Sine of an angle in turns, interpolated from a 1024 step table
+ * @param turns angle, any value, only the fraction of the turn matters
+ * @return Fixed  sine in [-1, 1]
+ */
+Fixed fixed_sin(Fixed turns);
+
+/** Cosine of an angle in turns, interpolated from a 1024 step table
+ * @param turns angle, any value, only the fraction of the turn matters
+ * @return Fixed  cosine in [-1, 1]
+ */
+Fixed fixed_cos(Fixed turns);
+
+/** Angle of the vector (x, y)
+ * @param y y component
+ * @param x x component
+ * @return Fixed  angle in turns, in [-0.5, 0.5], about 0.0006 turn accurate
+ */
+Fixed fixed_atan2(Fixed y, Fixed x);
+
+/** Table based sine for float angles in turns, drop-in for sinf(turns * 2 * PI)
+ * @param turns angle in turns, |turns| < 32768
+ * @return float  sine
+ */
+float fixed_sinf(float turns);
+
+/** Table based cosine for float angles in turns, drop-in for cosf(turns * 2 * PI)
+ * @param turns angle in turns, |turns| < 32768
+ * @return float  cosine
+ */
+float fixed_cosf(float turns);
+
+static inline FixedVector fixed_vector_add(FixedVector a, FixedVector b) {
+    return (FixedVector){.x = a.x + b.x, .y = a.y + b.y};
+}
+
+static inline FixedVector fixed_vector_sub(FixedVector a, FixedVector b) {
+    return (FixedVector){.x = a.x - b.x, .y = a.y - b.y};
+}
+
+static inline FixedVector fixed_vector_scale(FixedVector v, Fixed scale) {
+    return (FixedVector){.x = fixed_mul(v.x, scale), .y = fixed_mul(v.y, scale)};
+}
+
+static inline Fixed fixed_vector_dot(FixedVector a, FixedVector b) {
+    return (Fixed)(((int64_t)a.x * b.x + (int64_t)a.y * b.y) >> FIXED_SHIFT);
+}
+
+static inline FixedVector fixed_vector_from_vector(Vector v) {
+    return (FixedVector){.x = fixed_from_float(v.x), .y = fixed_from_float(v.y)};
+}
+
+static inline Vector fixed_vector_to_vector(FixedVector v) {
+    return (Vector){.x = fixed_to_float(v.x), .y = fixed_to_float(v.y)};
+}
+
+/** Length of a vector
+ * @param v vector
+ * @return Fixed  length
+ */
+Fixed fixed_vector_length(FixedVector v);
+
+/** Rotate a vector counter-clockwise
+ * @param v vector
+ * @param turns angle in turns
+ * @return FixedVector  rotated vector
+ */
+FixedVector fixed_vector_rotate(FixedVector v, Fixed turns);
+
+/** Unit vector pointing at an angle
+ * @param turns angle in turns
+ * @return FixedVector  (cos, sin)
+ */
+FixedVector fixed_vector_from_turn(Fixed turns);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,6 +5,16 @@
 #include <input/input.h>
 #include <notification/notification_messages.h>
 #include "clock_timer.h"
+#include "arena.h"
+#include "quality.h"
+
+#define TAG "GameEngine"
+
+#define FRAME_SCRATCH_SIZE 1024
+#define STARTUP_SCRATCH_SIZE 1024
+#define TASK_BUDGET_US 4000
+#define FRAME_THROTTLE_TICKS 2
+#define FRAME_THROTTLE_US (FRAME_THROTTLE_TICKS * 1000) // 1 ms kernel tick
 
 typedef _Atomic uint32_t AtomicUint32;
 
@@ -21,6 +31,7 @@ GameEngineSettings game_engine_settings_init() {
     settings.start_callback = NULL;
     settings.frame_callback = NULL;
     settings.stop_callback = NULL;
+    settings.task_budget_us = TASK_BUDGET_US;
     settings.context = NULL;
     return settings;
 }
@@ -32,6 +43,14 @@ struct GameEngine {
     FuriThreadId thread_id;
     GameEngineSettings settings;
     float fps;
+
+    Arena* frame_scratch;
+    Arena* startup_scratch;
+
+    ClockTimer clock_timer;
+    TaskQueue* tasks;
+    QualityGovernor* quality;
+    uint32_t commit_tick;
 };
 
 typedef enum {
@@ -51,6 +70,16 @@ GameEngine* game_engine_alloc(GameEngineSettings settings) {
     engine->thread_id = furi_thread_get_current_id();
     engine->settings = settings;
     engine->fps = 1.0f;
+    engine->frame_scratch = arena_alloc(FRAME_SCRATCH_SIZE);
+    engine->startup_scratch = arena_alloc(STARTUP_SCRATCH_SIZE);
+    engine->clock_timer = (ClockTimer){0};
+    engine->tasks = task_queue_alloc();
+
+    // frame work has to fit in the frame period, minus the throttle at the end of the frame
+    uint32_t frame_period_us = (uint32_t)(1000000.0f / settings.target_fps);
+    engine->quality = quality_governor_alloc(
+        frame_period_us > FRAME_THROTTLE_US * 2 ? frame_period_us - FRAME_THROTTLE_US :
+                                                  frame_period_us);
 
     return engine;
 }
@@ -59,6 +88,12 @@ void game_engine_free(GameEngine* engine) {
     furi_record_close(RECORD_GUI);
     furi_record_close(RECORD_NOTIFICATION);
     furi_record_close(RECORD_INPUT_EVENTS);
+    if(engine->startup_scratch) {
+        arena_free(engine->startup_scratch);
+    }
+    arena_free(engine->frame_scratch);
+    task_queue_free(engine->tasks);
+    quality_governor_free(engine->quality);
     free(engine);
 }
 
@@ -134,11 +169,20 @@ void game_engine_run(GameEngine* engine) {
         engine->settings.start_callback(engine, engine->settings.context);
     }
 
+    // init-time temporaries are not needed anymore
+    FURI_LOG_I(
+        TAG, "Startup scratch high-water: %u", arena_high_water_get(engine->startup_scratch));
+    arena_free(engine->startup_scratch);
+    engine->startup_scratch = NULL;
+
     // start "game update" timer
-    clock_timer_start(clock_timer_callback, engine, engine->settings.target_fps);
+    clock_timer_start(
+        &engine->clock_timer, clock_timer_callback, engine, engine->settings.target_fps);
 
     // init fps counter
     uint32_t time_start = DWT->CYCCNT;
+    uint32_t frame_cycles = SystemCoreClock / engine->settings.target_fps;
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
 
     while(true) {
         uint32_t flags =
@@ -146,6 +190,9 @@ void game_engine_run(GameEngine* engine) {
         furi_check((flags & FuriFlagError) == 0);
 
         if(flags & GameThreadFlagUpdate) {
+            // temporaries from the previous frame are gone
+            arena_reset(engine->frame_scratch);
+
             // update fps counter
             uint32_t time_end = DWT->CYCCNT;
             uint32_t time_delta = time_end - time_start;
@@ -173,13 +220,26 @@ void game_engine_run(GameEngine* engine) {
             if(engine->settings.show_fps) {
                 canvas_set_color(canvas, ColorXOR);
                 canvas_printf(canvas, 0, 7, "%lu", (uint32_t)roundf(engine->fps));
+                QualityState quality = quality_governor_state_get(engine->quality);
+                if(quality.steps_down > 0) {
+                    canvas_printf(canvas, 0, 15, "q-%u", quality.steps_down);
+                }
             }
 
             // and output screen buffer
             canvas_commit(canvas);
+            engine->commit_tick = furi_get_tick();
+
+            // let quality follow the frame time, then spend what is left of the frame on queued tasks
+            uint32_t frame_used = DWT->CYCCNT - time_end;
+            quality_governor_frame(engine->quality, frame_used / cycles_per_us);
+            if(frame_used < frame_cycles) {
+                uint32_t frame_left_us = (frame_cycles - frame_used) / cycles_per_us;
+                task_queue_run(engine->tasks, MIN(engine->settings.task_budget_us, frame_left_us));
+            }
 
             // throttle a bit
-            furi_delay_tick(2);
+            furi_delay_tick(FRAME_THROTTLE_TICKS);
         }
 
         if(flags & GameThreadFlagStop) {
@@ -188,7 +248,9 @@ void game_engine_run(GameEngine* engine) {
     }
 
     // stop timer
-    clock_timer_stop();
+    clock_timer_stop(&engine->clock_timer);
+
+    FURI_LOG_I(TAG, "Frame scratch high-water: %u", arena_high_water_get(engine->frame_scratch));
 
     // call stop callback, if any
     if(engine->settings.stop_callback) {
@@ -218,4 +280,29 @@ float game_engine_get_delta_frames(GameEngine* engine) {
 
 void game_engine_show_fps_set(GameEngine* engine, bool show_fps) {
     engine->settings.show_fps = show_fps;
+}
+
+bool game_engine_show_fps_get(GameEngine* engine) {
+    return engine->settings.show_fps;
+}
+
+uint32_t game_engine_commit_tick_get(GameEngine* engine) {
+    return engine->commit_tick;
+}
+
+Arena* game_engine_frame_scratch_get(GameEngine* engine) {
+    return engine->frame_scratch;
+}
+
+TaskQueue* game_engine_task_queue_get(GameEngine* engine) {
+    return engine->tasks;
+}
+
+QualityGovernor* game_engine_quality_get(GameEngine* engine) {
+    return engine->quality;
+}
+
+Arena* game_engine_startup_scratch_get(GameEngine* engine) {
+    furi_check(engine->startup_scratch, "Startup scratch is only available before the first frame");
+    return engine->startup_scratch;
 }
\ No newline at end of file
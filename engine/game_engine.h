@@ -1,6 +1,9 @@
 #pragma once
 #include <stdbool.h>
 #include "canvas.h"
+#include "arena.h"
+#include "task_queue.h"
+#include "quality.h"
 #include <gui/canvas.h>
 
 #ifdef __cplusplus
@@ -38,6 +41,7 @@ typedef struct {
     GameEngineStartCallback start_callback; // called when engine starts
     GameEngineFrameCallback frame_callback; // frame callback, called at target fps
     GameEngineStopCallback stop_callback; // called when engine stops
+    uint32_t task_budget_us; // max time per frame for queued tasks, capped by the time left in the frame
     void* context; // user context passed to callback
 } GameEngineSettings;
 
@@ -83,6 +87,46 @@ float game_engine_get_delta_frames(GameEngine* engine);
  */
 void game_engine_show_fps_set(GameEngine* engine, bool show_fps);
 
+/** Is the fps counter shown, games use it to switch on their own diagnostics
+ * @param engine GameEngine instance
+ * @return bool  true if shown
+ */
+bool game_engine_show_fps_get(GameEngine* engine);
+
+/** Get the furi tick at which the previous frame was committed to the screen
+ * @param engine GameEngine instance
+ * @return uint32_t  tick, 0 before the first frame
+ */
+uint32_t game_engine_commit_tick_get(GameEngine* engine);
+
+/** Get the frame scratch arena
+ * Everything allocated from it is released at the start of the next frame
+ * @param engine GameEngine instance
+ * @return Arena*  frame scratch arena
+ */
+Arena* game_engine_frame_scratch_get(GameEngine* engine);
+
+/** Get the task queue
+ * Tasks run after each frame is committed, in the time left before the next one
+ * @param engine GameEngine instance
+ * @return TaskQueue*  task queue
+ */
+TaskQueue* game_engine_task_queue_get(GameEngine* engine);
+
+/** Get the quality governor
+ * It is fed the time of every frame, games add their knobs to it and read them when drawing
+ * @param engine GameEngine instance
+ * @return QualityGovernor*  quality governor
+ */
+QualityGovernor* game_engine_quality_get(GameEngine* engine);
+
+/** Get the startup scratch arena, for temporaries of init-time work
+ * Released right before the first frame, must not be used after that
+ * @param engine GameEngine instance
+ * @return Arena*  startup scratch arena
+ */
+Arena* game_engine_startup_scratch_get(GameEngine* engine);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "game_manager.h"
+#include "game_manager_i.h"
 #include "level_i.h"
 #include <furi.h>
+#include <furi_hal_random.h>
 #include <m-list.h>
 #include <storage/storage.h>
 
@@ -20,6 +22,11 @@ struct GameManager {
     GameEngine* engine;
     InputState input;
     void* game_context;
+    const EntityRegistry* entity_registry;
+    Rng rng;
+    int32_t entities_count;
+    JobSystem* jobs;
+    IoWorker* io;
 
     SpriteCacheList_t sprites;
 };
@@ -31,14 +38,22 @@ GameManager* game_manager_alloc() {
     manager->next_level = NULL;
     manager->engine = NULL;
     manager->game_context = NULL;
+    manager->entity_registry = NULL;
+    rng_seed(&manager->rng, furi_hal_random_get());
+    manager->entities_count = 0;
+    manager->jobs = job_system_alloc(JOB_WORKERS_AUTO);
+    manager->io = io_worker_alloc();
     memset(&manager->input, 0, sizeof(InputState));
     SpriteCacheList_init(manager->sprites);
     return manager;
 }
 
-void game_manager_free(GameManager* manager) {
+int32_t game_manager_free(GameManager* manager) {
     level_call_stop(manager->current_level);
 
+    // pending I/O callbacks may still refer to levels, finish them first
+    io_worker_free(manager->io);
+
     // Free all levels
     {
         LevelList_it_t it;
@@ -63,7 +78,11 @@ void game_manager_free(GameManager* manager) {
         }
     }
     SpriteCacheList_clear(manager->sprites);
+    job_system_free(manager->jobs);
+
+    int32_t entities_count = manager->entities_count;
     free(manager);
+    return entities_count;
 }
 
 Level* game_manager_add_level(GameManager* manager, const LevelBehaviour* behaviour) {
@@ -92,6 +111,8 @@ Level* game_manager_current_level_get(GameManager* manager) {
 }
 
 void game_manager_update(GameManager* manager) {
+    io_worker_poll(manager->io);
+
     if(manager->next_level) {
         level_call_stop(manager->current_level);
         manager->current_level = manager->next_level;
@@ -118,6 +139,30 @@ void game_manager_game_context_set(GameManager* manager, void* context) {
     manager->game_context = context;
 }
 
+void game_manager_entity_registry_set(GameManager* manager, const EntityRegistry* registry) {
+    manager->entity_registry = registry;
+}
+
+const EntityRegistry* game_manager_entity_registry_get(GameManager* manager) {
+    return manager->entity_registry;
+}
+
+void game_manager_entities_count_add(GameManager* manager, int32_t delta) {
+    manager->entities_count += delta;
+}
+
+Rng* game_manager_rng_get(GameManager* manager) {
+    return &manager->rng;
+}
+
+IoWorker* game_manager_io_get(GameManager* manager) {
+    return manager->io;
+}
+
+JobSystem* game_manager_jobs_get(GameManager* manager) {
+    return manager->jobs;
+}
+
 GameEngine* game_manager_engine_get(GameManager* manager) {
     return manager->engine;
 }
@@ -135,7 +180,7 @@ void game_manager_show_fps_set(GameManager* manager, bool show_fps) {
     game_engine_show_fps_set(engine, show_fps);
 }
 
-Sprite* game_manager_sprite_load(GameManager* manager, const char* path) {
+static Sprite* game_manager_sprite_cached(GameManager* manager, const char* path) {
     SpriteCacheList_it_t it;
     SpriteCacheList_it(it, manager->sprites);
     while(!SpriteCacheList_end_p(it)) {
@@ -144,6 +189,14 @@ Sprite* game_manager_sprite_load(GameManager* manager, const char* path) {
         }
         SpriteCacheList_next(it);
     }
+    return NULL;
+}
+
+Sprite* game_manager_sprite_load(GameManager* manager, const char* path) {
+    Sprite* cached = game_manager_sprite_cached(manager, path);
+    if(cached) {
+        return cached;
+    }
 
     FuriString* path_full = furi_string_alloc_set(APP_ASSETS_PATH("sprites/"));
     furi_string_cat(path_full, path);
@@ -161,6 +214,65 @@ Sprite* game_manager_sprite_load(GameManager* manager, const char* path) {
     return sprite;
 }
 
+typedef struct {
+    GameManager* manager;
+    FuriString* path;
+    SpriteLoadCallback callback;
+    void* context;
+} SpriteCacheLoad;
+
+static void game_manager_sprite_loaded(Sprite* sprite, void* context) {
+    SpriteCacheLoad* load = context;
+    const char* path = furi_string_get_cstr(load->path);
+
+    // another load of the same file may have finished first
+    Sprite* cached = game_manager_sprite_cached(load->manager, path);
+    if(cached) {
+        sprite_free(sprite);
+        sprite = cached;
+    } else if(sprite) {
+        SpriteCache cache = {
+            .sprite = sprite,
+            .path = furi_string_alloc_set(path),
+        };
+        SpriteCacheList_push_back(load->manager->sprites, cache);
+    }
+
+    load->callback(sprite, load->context);
+    furi_string_free(load->path);
+    free(load);
+}
+
+bool game_manager_sprite_load_async(
+    GameManager* manager,
+    const char* path,
+    SpriteLoadCallback callback,
+    void* context) {
+    Sprite* cached = game_manager_sprite_cached(manager, path);
+    if(cached) {
+        callback(cached, context);
+        return true;
+    }
+
+    SpriteCacheLoad* load = malloc(sizeof(SpriteCacheLoad));
+    load->manager = manager;
+    load->path = furi_string_alloc_set(path);
+    load->callback = callback;
+    load->context = context;
+
+    FuriString* path_full = furi_string_alloc_set(APP_ASSETS_PATH("sprites/"));
+    furi_string_cat(path_full, path);
+    bool queued = sprite_alloc_async(
+        manager->io, furi_string_get_cstr(path_full), game_manager_sprite_loaded, load);
+    furi_string_free(path_full);
+
+    if(!queued) {
+        furi_string_free(load->path);
+        free(load);
+    }
+    return queued;
+}
+
 Level* game_manager_entity_level_get(GameManager* manager, Entity* entity) {
     LevelList_it_t it;
     LevelList_it(it, manager->levels);
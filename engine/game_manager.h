@@ -2,6 +2,9 @@
 #include "level.h"
 #include "game_engine.h"
 #include "sprite.h"
+#include "rng.h"
+#include "job.h"
+#include "io_worker.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +43,34 @@ InputState game_manager_input_get(GameManager* manager);
 
 void* game_manager_game_context_get(GameManager* manager);
 
+/**
+ * @brief Get the root random stream of the game
+ * Seeded from the hardware generator, reseed it with rng_seed before adding levels for reproducible runs.
+ * Every level splits its own stream from it when added.
+ * 
+ * @param manager game manager instance
+ * @return Rng* random stream
+ */
+Rng* game_manager_rng_get(GameManager* manager);
+
+/**
+ * @brief Get the storage I/O worker of the game
+ * Completion callbacks run at the start of each game manager update
+ * 
+ * @param manager game manager instance
+ * @return IoWorker* I/O worker
+ */
+IoWorker* game_manager_io_get(GameManager* manager);
+
+/**
+ * @brief Get the job system of the game
+ * Runs jobs on worker threads in host builds and inline on the device
+ * 
+ * @param manager game manager instance
+ * @return JobSystem* job system
+ */
+JobSystem* game_manager_jobs_get(GameManager* manager);
+
 void game_manager_game_stop(GameManager* manager);
 
 void game_manager_show_fps_set(GameManager* manager, bool show_fps);
@@ -54,6 +85,22 @@ void game_manager_show_fps_set(GameManager* manager, bool show_fps);
  */
 Sprite* game_manager_sprite_load(GameManager* manager, const char* path);
 
+/**
+ * @brief Load a sprite without waiting for the SD card
+ * Sprite will be cached like with game_manager_sprite_load, cached sprites are returned right away
+ * 
+ * @param manager game manager instance
+ * @param path sprite file path, relative to the game's assets folder
+ * @param callback called with the sprite, or NULL if it could not be loaded
+ * @param context callback context
+ * @return true if the load was queued or the sprite was cached
+ */
+bool game_manager_sprite_load_async(
+    GameManager* manager,
+    const char* path,
+    SpriteLoadCallback callback,
+    void* context);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
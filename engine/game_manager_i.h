@@ -7,7 +7,13 @@ extern "C" {
 
 GameManager* game_manager_alloc(void);
 
-void game_manager_free(GameManager* manager);
+/**
+ * @brief Free the game manager and all its levels
+ * 
+ * @param manager game manager instance
+ * @return int32_t number of entities that were never released, anything but 0 is a leak
+ */
+int32_t game_manager_free(GameManager* manager);
 
 void game_manager_update(GameManager* manager);
 
@@ -19,6 +25,12 @@ void game_manager_input_set(GameManager* manager, InputState input);
 
 void game_manager_game_context_set(GameManager* manager, void* context);
 
+void game_manager_entity_registry_set(GameManager* manager, const EntityRegistry* registry);
+
+const EntityRegistry* game_manager_entity_registry_get(GameManager* manager);
+
+void game_manager_entities_count_add(GameManager* manager, int32_t delta);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,545 @@
+#include "io_worker.h"
+#include <furi.h>
+#include <stdatomic.h>
+#include <storage/storage.h>
+
+#define TAG "IoWorker"
+
+#define IO_WORKER_RING_SIZE 16 // power of two
+#define IO_WORKER_STACK_SIZE 2048
+#define IO_STREAM_CHUNKS 2
+#define IO_STREAM_CHUNK_SIZE 512
+
+typedef enum {
+    IoRequestRead,
+    IoRequestWrite,
+    IoRequestAppend,
+    IoRequestStreamFill,
+    IoRequestStreamClose,
+    IoRequestStop,
+} IoRequestType;
+
+typedef enum {
+    IoWorkerFlagRequest = 1 << 0,
+} IoWorkerFlag;
+
+typedef struct {
+    IoRequestType type;
+    FuriString* path;
+    uint32_t offset;
+    void* data;
+    size_t size;
+    IoWorkerCallback callback;
+    void* context;
+    IoStream* stream;
+    size_t chunk;
+} IoRequest;
+
+typedef struct {
+    IoRequest request;
+    bool success;
+} IoCompletion;
+
+// single producer, single consumer, each index is written by one side only
+typedef struct {
+    void* items;
+    size_t item_size;
+    _Atomic uint32_t head; // written by the consumer
+    _Atomic uint32_t tail; // written by the producer
+} IoRing;
+
+typedef enum {
+    IoChunkLoading,
+    IoChunkReady,
+    IoChunkEmpty, // consumed, refill request not queued yet
+} IoChunkState;
+
+typedef struct {
+    IoChunkState state;
+    uint32_t offset; // file offset of the data, refills can finish out of order
+    size_t size;
+    size_t position;
+    uint8_t data[IO_STREAM_CHUNK_SIZE];
+} IoChunk;
+
+struct IoStream {
+    IoWorker* worker;
+    FuriString* path;
+    File* file; // worker thread only
+    IoChunk chunks[IO_STREAM_CHUNKS];
+    size_t chunk; // chunk to read next
+    uint32_t end; // file size, UINT32_MAX until a short chunk comes back
+    bool failed;
+    struct IoStream* next_closing;
+};
+
+struct IoWorker {
+    FuriThread* thread;
+    IoRing requests;
+    IoRing completions;
+    IoRequest request_items[IO_WORKER_RING_SIZE];
+    IoCompletion completion_items[IO_WORKER_RING_SIZE];
+    IoStream* closing; // streams whose close request did not fit in the queue yet
+};
+
+static void io_ring_init(IoRing* ring, void* items, size_t item_size) {
+    ring->items = items;
+    ring->item_size = item_size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+}
+
+static bool io_ring_push(IoRing* ring, const void* item) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if(tail - head == IO_WORKER_RING_SIZE) {
+        return false;
+    }
+    uint8_t* slot = (uint8_t*)ring->items + (tail % IO_WORKER_RING_SIZE) * ring->item_size;
+    memcpy(slot, item, ring->item_size);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static bool io_ring_pop(IoRing* ring, void* item) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if(head == tail) {
+        return false;
+    }
+    uint8_t* slot = (uint8_t*)ring->items + (head % IO_WORKER_RING_SIZE) * ring->item_size;
+    memcpy(item, slot, ring->item_size);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+static bool io_worker_handle_read(File* file, IoRequest* request) {
+    const char* path = furi_string_get_cstr(request->path);
+    if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_E(TAG, "Failed to open %s", path);
+        return false;
+    }
+
+    bool success = false;
+    do {
+        uint64_t file_size = storage_file_size(file);
+        if(request->offset > file_size || !storage_file_seek(file, request->offset, true)) {
+            break;
+        }
+
+        size_t size = request->size ? request->size : (size_t)(file_size - request->offset);
+        request->data = malloc(size);
+        request->size = storage_file_read(file, request->data, size);
+        success = request->size == size;
+    } while(false);
+
+    storage_file_close(file);
+    return success;
+}
+
+static bool io_worker_handle_write(File* file, IoRequest* request, FS_OpenMode mode) {
+    const char* path = furi_string_get_cstr(request->path);
+    if(!storage_file_open(file, path, FSAM_WRITE, mode)) {
+        FURI_LOG_E(TAG, "Failed to open %s", path);
+        return false;
+    }
+
+    bool success = storage_file_write(file, request->data, request->size) == request->size;
+    storage_file_close(file);
+    return success;
+}
+
+static bool io_worker_handle_stream_fill(Storage* storage, IoRequest* request) {
+    IoStream* stream = request->stream;
+    if(!stream->file) {
+        stream->file = storage_file_alloc(storage);
+        if(!storage_file_open(
+               stream->file, furi_string_get_cstr(stream->path), FSAM_READ, FSOM_OPEN_EXISTING)) {
+            FURI_LOG_E(TAG, "Failed to open %s", furi_string_get_cstr(stream->path));
+            return false;
+        }
+    }
+
+    if(!storage_file_is_open(stream->file)) {
+        return false;
+    }
+
+    // the chunk is owned by the worker until its completion is polled
+    IoChunk* chunk = &stream->chunks[request->chunk];
+    if(request->offset >= storage_file_size(stream->file)) {
+        // read ahead past the end before the size was known
+        request->size = 0;
+        return true;
+    }
+    if(!storage_file_seek(stream->file, request->offset, true)) {
+        return false;
+    }
+    request->size = storage_file_read(stream->file, chunk->data, IO_STREAM_CHUNK_SIZE);
+    return true;
+}
+
+static void io_worker_handle_stream_close(IoRequest* request) {
+    IoStream* stream = request->stream;
+    if(stream->file) {
+        storage_file_free(stream->file);
+        stream->file = NULL;
+    }
+}
+
+static void io_worker_complete(IoWorker* worker, IoRequest* request, bool success) {
+    IoCompletion completion = {.request = *request, .success = success};
+    while(!io_ring_push(&worker->completions, &completion)) {
+        // the game thread has not polled for a while, only the worker waits here
+        furi_delay_tick(1);
+    }
+}
+
+static int32_t io_worker_thread(void* context) {
+    IoWorker* worker = context;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    while(true) {
+        IoRequest request;
+        if(!io_ring_pop(&worker->requests, &request)) {
+            furi_thread_flags_wait(IoWorkerFlagRequest, FuriFlagWaitAny, FuriWaitForever);
+            continue;
+        }
+
+        bool success = false;
+        switch(request.type) {
+        case IoRequestRead:
+            success = io_worker_handle_read(file, &request);
+            break;
+        case IoRequestWrite:
+            success = io_worker_handle_write(file, &request, FSOM_CREATE_ALWAYS);
+            break;
+        case IoRequestAppend:
+            success = io_worker_handle_write(file, &request, FSOM_OPEN_APPEND);
+            break;
+        case IoRequestStreamFill:
+            success = io_worker_handle_stream_fill(storage, &request);
+            break;
+        case IoRequestStreamClose:
+            io_worker_handle_stream_close(&request);
+            success = true;
+            break;
+        case IoRequestStop:
+            break;
+        }
+
+        if(request.type == IoRequestStop) {
+            break;
+        }
+        io_worker_complete(worker, &request, success);
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return 0;
+}
+
+IoWorker* io_worker_alloc(void) {
+    IoWorker* worker = malloc(sizeof(IoWorker));
+    io_ring_init(&worker->requests, worker->request_items, sizeof(IoRequest));
+    io_ring_init(&worker->completions, worker->completion_items, sizeof(IoCompletion));
+    worker->closing = NULL;
+    worker->thread =
+        furi_thread_alloc_ex(TAG, IO_WORKER_STACK_SIZE, io_worker_thread, worker);
+    furi_thread_start(worker->thread);
+    return worker;
+}
+
+static bool io_worker_submit(IoWorker* worker, const IoRequest* request) {
+    if(!io_ring_push(&worker->requests, request)) {
+        return false;
+    }
+    furi_thread_flags_set(furi_thread_get_id(worker->thread), IoWorkerFlagRequest);
+    return true;
+}
+
+static void io_worker_release(IoRequest* request) {
+    if(request->path) {
+        furi_string_free(request->path);
+    }
+    if(request->type != IoRequestRead && request->type != IoRequestStreamFill) {
+        // write buffers are copies made at submit time
+        free(request->data);
+    }
+}
+
+static void io_stream_free(IoStream* stream) {
+    furi_string_free(stream->path);
+    free(stream);
+}
+
+static void io_worker_discard_completions(IoWorker* worker) {
+    IoCompletion completion;
+    while(io_ring_pop(&worker->completions, &completion)) {
+        IoRequest* request = &completion.request;
+        if(request->type == IoRequestStreamClose) {
+            io_stream_free(request->stream);
+            continue;
+        }
+        if(request->type == IoRequestStreamFill) {
+            continue;
+        }
+
+        // callers may own memory tied to the request, let them release it
+        io_worker_release(request);
+        void* data = request->type == IoRequestRead ? request->data : NULL;
+        if(request->callback) {
+            request->callback(false, data, 0, request->context);
+        } else {
+            free(data);
+        }
+    }
+}
+
+static void io_worker_submit_closing(IoWorker* worker) {
+    while(worker->closing) {
+        IoStream* stream = worker->closing;
+        IoRequest request = {
+            .type = IoRequestStreamClose,
+            .stream = stream,
+        };
+        if(!io_worker_submit(worker, &request)) {
+            break;
+        }
+        worker->closing = stream->next_closing;
+    }
+}
+
+void io_worker_free(IoWorker* worker) {
+    // shutting down, waiting for the worker is fine here
+    IoRequest stop = {.type = IoRequestStop};
+    while(worker->closing || !io_worker_submit(worker, &stop)) {
+        io_worker_discard_completions(worker);
+        io_worker_submit_closing(worker);
+        furi_delay_tick(1);
+    }
+
+    // the worker finishes the requests before the stop and blocks while the completions
+    // are full, so keep draining them until it is gone
+    while(furi_thread_get_state(worker->thread) != FuriThreadStateStopped) {
+        io_worker_discard_completions(worker);
+        furi_delay_tick(1);
+    }
+    furi_thread_join(worker->thread);
+    furi_thread_free(worker->thread);
+    io_worker_discard_completions(worker);
+
+    free(worker);
+}
+
+bool io_worker_read(
+    IoWorker* worker,
+    const char* path,
+    uint32_t offset,
+    size_t size,
+    IoWorkerCallback callback,
+    void* context) {
+    IoRequest request = {
+        .type = IoRequestRead,
+        .path = furi_string_alloc_set(path),
+        .offset = offset,
+        .size = size,
+        .callback = callback,
+        .context = context,
+    };
+    if(!io_worker_submit(worker, &request)) {
+        furi_string_free(request.path);
+        return false;
+    }
+    return true;
+}
+
+static bool io_worker_write_request(
+    IoWorker* worker,
+    IoRequestType type,
+    const char* path,
+    const void* data,
+    size_t size,
+    IoWorkerCallback callback,
+    void* context) {
+    IoRequest request = {
+        .type = type,
+        .path = furi_string_alloc_set(path),
+        .data = malloc(size),
+        .size = size,
+        .callback = callback,
+        .context = context,
+    };
+    memcpy(request.data, data, size);
+    if(!io_worker_submit(worker, &request)) {
+        io_worker_release(&request);
+        return false;
+    }
+    return true;
+}
+
+bool io_worker_write(
+    IoWorker* worker,
+    const char* path,
+    const void* data,
+    size_t size,
+    IoWorkerCallback callback,
+    void* context) {
+    return io_worker_write_request(
+        worker, IoRequestWrite, path, data, size, callback, context);
+}
+
+bool io_worker_append(
+    IoWorker* worker,
+    const char* path,
+    const void* data,
+    size_t size,
+    IoWorkerCallback callback,
+    void* context) {
+    return io_worker_write_request(
+        worker, IoRequestAppend, path, data, size, callback, context);
+}
+
+static bool io_stream_fill(IoStream* stream, size_t chunk) {
+    IoRequest request = {
+        .type = IoRequestStreamFill,
+        .offset = stream->chunks[chunk].offset,
+        .stream = stream,
+        .chunk = chunk,
+    };
+    if(!io_worker_submit(stream->worker, &request)) {
+        stream->chunks[chunk].state = IoChunkEmpty;
+        return false;
+    }
+    stream->chunks[chunk].state = IoChunkLoading;
+    return true;
+}
+
+static void io_stream_complete(IoCompletion* completion) {
+    IoStream* stream = completion->request.stream;
+    if(completion->request.type == IoRequestStreamClose) {
+        io_stream_free(stream);
+        return;
+    }
+
+    IoChunk* chunk = &stream->chunks[completion->request.chunk];
+    chunk->state = IoChunkReady;
+    chunk->size = completion->request.size;
+    chunk->position = 0;
+    if(!completion->success) {
+        stream->failed = true;
+    }
+    if(completion->success && chunk->size < IO_STREAM_CHUNK_SIZE) {
+        // nothing after this one has data, whichever chunk finds the end first
+        stream->end = MIN(stream->end, chunk->offset + chunk->size);
+    }
+}
+
+void io_worker_poll(IoWorker* worker) {
+    IoCompletion completion;
+    while(io_ring_pop(&worker->completions, &completion)) {
+        IoRequest* request = &completion.request;
+        if(request->type == IoRequestStreamFill || request->type == IoRequestStreamClose) {
+            io_stream_complete(&completion);
+            continue;
+        }
+
+        io_worker_release(request);
+        void* data = request->type == IoRequestRead ? request->data : NULL;
+        if(request->callback) {
+            request->callback(completion.success, data, request->size, request->context);
+        } else {
+            free(data);
+        }
+    }
+
+    io_worker_submit_closing(worker);
+}
+
+IoStream* io_stream_open(IoWorker* worker, const char* path) {
+    IoStream* stream = malloc(sizeof(IoStream));
+    stream->worker = worker;
+    stream->path = furi_string_alloc_set(path);
+    stream->file = NULL;
+    stream->chunk = 0;
+    stream->end = UINT32_MAX;
+    stream->failed = false;
+
+    stream->next_closing = NULL;
+
+    for(size_t i = 0; i < IO_STREAM_CHUNKS; i++) {
+        stream->chunks[i].offset = i * IO_STREAM_CHUNK_SIZE;
+    }
+    if(!io_stream_fill(stream, 0)) {
+        io_stream_free(stream);
+        return NULL;
+    }
+    for(size_t i = 1; i < IO_STREAM_CHUNKS; i++) {
+        io_stream_fill(stream, i);
+    }
+    return stream;
+}
+
+size_t io_stream_read(IoStream* stream, void* data, size_t size) {
+    uint8_t* out = data;
+    size_t read = 0;
+
+    while(read < size && !stream->failed) {
+        IoChunk* chunk = &stream->chunks[stream->chunk];
+        if(chunk->state == IoChunkEmpty && chunk->offset < stream->end) {
+            // the queue was full last time, try again
+            io_stream_fill(stream, stream->chunk);
+        }
+        if(chunk->state != IoChunkReady) {
+            break;
+        }
+
+        size_t count = MIN(size - read, chunk->size - chunk->position);
+        memcpy(out + read, chunk->data + chunk->position, count);
+        chunk->position += count;
+        read += count;
+
+        if(chunk->position < chunk->size) {
+            break;
+        }
+
+        // chunk used up, the last one of the file stays as it is
+        if(chunk->size < IO_STREAM_CHUNK_SIZE) {
+            break;
+        }
+        // the next data for this chunk is a whole ring further into the file
+        chunk->offset += IO_STREAM_CHUNKS * IO_STREAM_CHUNK_SIZE;
+        if(chunk->offset >= stream->end) {
+            chunk->state = IoChunkEmpty;
+        } else {
+            io_stream_fill(stream, stream->chunk);
+        }
+        stream->chunk = (stream->chunk + 1) % IO_STREAM_CHUNKS;
+    }
+
+    return read;
+}
+
+bool io_stream_eof(const IoStream* stream) {
+    if(stream->failed) {
+        return true;
+    }
+    const IoChunk* chunk = &stream->chunks[stream->chunk];
+    if(chunk->state == IoChunkEmpty) {
+        return chunk->offset >= stream->end;
+    }
+    return chunk->state == IoChunkReady && chunk->position == chunk->size &&
+           chunk->offset + chunk->size >= stream->end;
+}
+
+void io_stream_close(IoStream* stream) {
+    // queued behind any fill in flight, io_worker_poll retries if the queue is full
+    IoWorker* worker = stream->worker;
+    stream->next_closing = NULL;
+    IoStream** tail = &worker->closing;
+    while(*tail) {
+        tail = &(*tail)->next_closing;
+    }
+    *tail = stream;
+    io_worker_submit_closing(worker);
+}
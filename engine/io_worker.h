@@ -0,0 +1,128 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Storage I/O on a worker thread.
+ * Requests go to the worker through a lock-free single producer, single consumer
+ * ring, results come back through a second one and their callbacks run on the game
+ * thread from io_worker_poll. Nothing here waits for the SD card, a full ring makes
+ * the request fail right away instead.
+ * All functions except io_worker_alloc and io_worker_free must be called from one
+ * thread, the game thread.
+ */
+typedef struct IoWorker IoWorker;
+
+/** Sequential file reader with read-ahead, see io_stream_open */
+typedef struct IoStream IoStream;
+
+/** Request completion callback, called from io_worker_poll
+ * @param success true if the whole request succeeded
+ * @param data read data, owned by the callback and released with free(), NULL for writes
+ * @param size size of the data read or written
+ * @param context request context
+ */
+typedef void (*IoWorkerCallback)(bool success, void* data, size_t size, void* context);
+
+/** Allocate the worker and start its thread
+ * @return IoWorker*  IoWorker instance
+ */
+IoWorker* io_worker_alloc(void);
+
+/** Stop the worker thread and free it
+ * Waits for queued requests, callbacks that were not polled yet are called as failed
+ * @param worker IoWorker instance
+ */
+void io_worker_free(IoWorker* worker);
+
+/** Read from a file
+ * @param worker IoWorker instance
+ * @param path file path
+ * @param offset offset of the first byte
+ * @param size number of bytes to read, 0 for the rest of the file
+ * @param callback completion callback, gets a malloc'ed buffer with the data
+ * @param context callback context
+ * @return true if the request was queued
+ */
+bool io_worker_read(
+    IoWorker* worker,
+    const char* path,
+    uint32_t offset,
+    size_t size,
+    IoWorkerCallback callback,
+    void* context);
+
+/** Replace a file with new contents
+ * @param worker IoWorker instance
+ * @param path file path
+ * @param data data to write, copied, so the caller can reuse it right away
+ * @param size data size
+ * @param callback completion callback, can be NULL
+ * @param context callback context
+ * @return true if the request was queued
+ */
+bool io_worker_write(
+    IoWorker* worker,
+    const char* path,
+    const void* data,
+    size_t size,
+    IoWorkerCallback callback,
+    void* context);
+
+/** Append to a file, creating it if needed
+ * @param worker IoWorker instance
+ * @param path file path
+ * @param data data to append, copied
+ * @param size data size
+ * @param callback completion callback, can be NULL
+ * @param context callback context
+ * @return true if the request was queued
+ */
+bool io_worker_append(
+    IoWorker* worker,
+    const char* path,
+    const void* data,
+    size_t size,
+    IoWorkerCallback callback,
+    void* context);
+
+/** Run the callbacks of finished requests
+ * @param worker IoWorker instance
+ */
+void io_worker_poll(IoWorker* worker);
+
+/** Open a file for sequential reading
+ * The worker keeps the next chunk loaded ahead of the reader
+ * @param worker IoWorker instance
+ * @param path file path
+ * @return IoStream*  IoStream instance, NULL if the request queue is full
+ */
+IoStream* io_stream_open(IoWorker* worker, const char* path);
+
+/** Read what is already loaded, never waits
+ * @param stream IoStream instance
+ * @param data output buffer
+ * @param size max bytes to read
+ * @return size_t  bytes read, 0 if the next chunk is not loaded yet
+ */
+size_t io_stream_read(IoStream* stream, void* data, size_t size);
+
+/** Check if the whole file was read, or reading failed
+ * @param stream IoStream instance
+ * @return true at the end of the file
+ */
+bool io_stream_eof(const IoStream* stream);
+
+/** Close the stream, it is freed once the worker is done with it
+ * @param stream IoStream instance
+ */
+void io_stream_close(IoStream* stream);
+
+#ifdef __cplusplus
+}
+#endif
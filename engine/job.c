@@ -0,0 +1,303 @@
+#include "job.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef ENGINE_HOST
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define JOB_QUEUE_SIZE 256
+#define JOB_RANGES_PER_WORKER 4
+
+typedef struct {
+    JobCallback callback;
+    void* context;
+    JobGroup* group;
+} Job;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    Job jobs[JOB_QUEUE_SIZE];
+    size_t head; // stealing end, oldest job
+    size_t tail; // owner end, newest job
+} JobQueue;
+
+typedef struct {
+    JobSystem* system;
+    size_t index;
+} JobWorker;
+
+struct JobSystem {
+    size_t workers_count;
+    pthread_t* threads;
+    JobWorker* workers;
+
+    // one queue per worker, plus a shared one for threads outside the pool
+    JobQueue* queues;
+    size_t queues_count;
+
+    pthread_mutex_t sleep_mutex;
+    pthread_cond_t sleep_cond;
+    _Atomic uint32_t queued;
+    _Atomic bool running;
+};
+
+static _Thread_local JobWorker* job_current_worker = NULL;
+
+static size_t job_queue_index(JobSystem* system) {
+    if(job_current_worker && job_current_worker->system == system) {
+        return job_current_worker->index;
+    }
+    return system->workers_count;
+}
+
+static bool job_queue_push(JobQueue* queue, Job job) {
+    pthread_mutex_lock(&queue->mutex);
+    bool pushed = queue->tail - queue->head < JOB_QUEUE_SIZE;
+    if(pushed) {
+        queue->jobs[queue->tail % JOB_QUEUE_SIZE] = job;
+        queue->tail++;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return pushed;
+}
+
+static bool job_queue_pop(JobQueue* queue, Job* job) {
+    pthread_mutex_lock(&queue->mutex);
+    bool popped = queue->tail != queue->head;
+    if(popped) {
+        queue->tail--;
+        *job = queue->jobs[queue->tail % JOB_QUEUE_SIZE];
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return popped;
+}
+
+static bool job_queue_steal(JobQueue* queue, Job* job) {
+    pthread_mutex_lock(&queue->mutex);
+    bool stolen = queue->tail != queue->head;
+    if(stolen) {
+        *job = queue->jobs[queue->head % JOB_QUEUE_SIZE];
+        queue->head++;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return stolen;
+}
+
+static bool job_find(JobSystem* system, size_t index, Job* job) {
+    // own queue newest first for locality, then steal the oldest jobs from the others
+    bool found = job_queue_pop(&system->queues[index], job);
+    for(size_t i = 1; !found && i < system->queues_count; i++) {
+        found = job_queue_steal(&system->queues[(index + i) % system->queues_count], job);
+    }
+    if(found) {
+        atomic_fetch_sub(&system->queued, 1);
+    }
+    return found;
+}
+
+static void job_execute(Job* job) {
+    job->callback(job->context);
+    atomic_fetch_sub(&job->group->pending, 1);
+}
+
+static void* job_worker_thread(void* context) {
+    JobWorker* worker = context;
+    JobSystem* system = worker->system;
+    job_current_worker = worker;
+
+    while(atomic_load(&system->running)) {
+        Job job;
+        if(job_find(system, worker->index, &job)) {
+            job_execute(&job);
+            continue;
+        }
+
+        pthread_mutex_lock(&system->sleep_mutex);
+        while(atomic_load(&system->queued) == 0 && atomic_load(&system->running)) {
+            pthread_cond_wait(&system->sleep_cond, &system->sleep_mutex);
+        }
+        pthread_mutex_unlock(&system->sleep_mutex);
+    }
+
+    job_current_worker = NULL;
+    return NULL;
+}
+
+JobSystem* job_system_alloc(size_t workers) {
+    if(workers == JOB_WORKERS_AUTO) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cores > 1 ? (size_t)cores - 1 : 0;
+    }
+
+    JobSystem* system = malloc(sizeof(JobSystem));
+    system->workers_count = workers;
+    system->queues_count = workers + 1;
+    system->queues = calloc(system->queues_count, sizeof(JobQueue));
+    for(size_t i = 0; i < system->queues_count; i++) {
+        pthread_mutex_init(&system->queues[i].mutex, NULL);
+    }
+    pthread_mutex_init(&system->sleep_mutex, NULL);
+    pthread_cond_init(&system->sleep_cond, NULL);
+    atomic_init(&system->queued, 0);
+    atomic_init(&system->running, true);
+
+    system->threads = calloc(workers, sizeof(pthread_t));
+    system->workers = calloc(workers, sizeof(JobWorker));
+    for(size_t i = 0; i < workers; i++) {
+        system->workers[i] = (JobWorker){.system = system, .index = i};
+        pthread_create(&system->threads[i], NULL, job_worker_thread, &system->workers[i]);
+    }
+
+    return system;
+}
+
+void job_system_free(JobSystem* system) {
+    pthread_mutex_lock(&system->sleep_mutex);
+    atomic_store(&system->running, false);
+    pthread_cond_broadcast(&system->sleep_cond);
+    pthread_mutex_unlock(&system->sleep_mutex);
+
+    for(size_t i = 0; i < system->workers_count; i++) {
+        pthread_join(system->threads[i], NULL);
+    }
+
+    for(size_t i = 0; i < system->queues_count; i++) {
+        pthread_mutex_destroy(&system->queues[i].mutex);
+    }
+    pthread_mutex_destroy(&system->sleep_mutex);
+    pthread_cond_destroy(&system->sleep_cond);
+    free(system->workers);
+    free(system->threads);
+    free(system->queues);
+    free(system);
+}
+
+size_t job_system_workers_get(const JobSystem* system) {
+    return system->workers_count;
+}
+
+void job_submit(JobSystem* system, JobGroup* group, JobCallback callback, void* context) {
+    atomic_fetch_add(&group->pending, 1);
+    Job job = {.callback = callback, .context = context, .group = group};
+
+    // count the job before a worker can pop it, or the pop takes queued below zero
+    atomic_fetch_add(&system->queued, 1);
+    if(system->workers_count == 0 ||
+       !job_queue_push(&system->queues[job_queue_index(system)], job)) {
+        // no workers or the queue is full, just do it here
+        atomic_fetch_sub(&system->queued, 1);
+        job_execute(&job);
+        return;
+    }
+
+    pthread_mutex_lock(&system->sleep_mutex);
+    pthread_cond_signal(&system->sleep_cond);
+    pthread_mutex_unlock(&system->sleep_mutex);
+}
+
+void job_wait(JobSystem* system, JobGroup* group) {
+    size_t index = job_queue_index(system);
+    while(atomic_load(&group->pending) > 0) {
+        Job job;
+        if(job_find(system, index, &job)) {
+            job_execute(&job);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+typedef struct {
+    size_t start;
+    size_t end;
+    JobRangeCallback callback;
+    void* context;
+} JobRange;
+
+static void job_range_execute(void* context) {
+    JobRange* range = context;
+    range->callback(range->start, range->end, range->context);
+}
+
+void job_parallel_for(
+    JobSystem* system,
+    size_t count,
+    size_t grain,
+    JobRangeCallback callback,
+    void* context) {
+    size_t max_ranges = (system->workers_count + 1) * JOB_RANGES_PER_WORKER;
+    size_t min_grain = (count + max_ranges - 1) / max_ranges;
+    if(grain < min_grain) {
+        grain = min_grain;
+    }
+
+    if(system->workers_count == 0 || count <= grain) {
+        callback(0, count, context);
+        return;
+    }
+
+    size_t ranges_count = (count + grain - 1) / grain;
+    JobRange* ranges = malloc(ranges_count * sizeof(JobRange));
+    JobGroup group = {0};
+    for(size_t i = 0; i < ranges_count; i++) {
+        size_t start = i * grain;
+        ranges[i] = (JobRange){
+            .start = start,
+            .end = start + grain < count ? start + grain : count,
+            .callback = callback,
+            .context = context,
+        };
+        job_submit(system, &group, job_range_execute, &ranges[i]);
+    }
+    job_wait(system, &group);
+    free(ranges);
+}
+
+#else
+
+struct JobSystem {
+    size_t workers_count;
+};
+
+JobSystem* job_system_alloc(size_t workers) {
+    (void)workers;
+    JobSystem* system = malloc(sizeof(JobSystem));
+    system->workers_count = 0;
+    return system;
+}
+
+void job_system_free(JobSystem* system) {
+    free(system);
+}
+
+size_t job_system_workers_get(const JobSystem* system) {
+    return system->workers_count;
+}
+
+void job_submit(JobSystem* system, JobGroup* group, JobCallback callback, void* context) {
+    (void)system;
+    (void)group;
+    callback(context);
+}
+
+void job_wait(JobSystem* system, JobGroup* group) {
+    (void)system;
+    (void)group;
+}
+
+void job_parallel_for(
+    JobSystem* system,
+    size_t count,
+    size_t grain,
+    JobRangeCallback callback,
+    void* context) {
+    (void)system;
+    (void)grain;
+    // single core, one range has the least overhead
+    callback(0, count, context);
+}
+
+#endif
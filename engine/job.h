@@ -0,0 +1,76 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Job system.
+ * Host builds (ENGINE_HOST) run jobs on a work-stealing thread pool, on the device
+ * every job runs inline in the caller, so game code is the same on both.
+ */
+typedef struct JobSystem JobSystem;
+
+/** Group of jobs to wait for, zero initialize before the first submit */
+typedef struct {
+    _Atomic uint32_t pending;
+} JobGroup;
+
+typedef void (*JobCallback)(void* context);
+
+/** Parallel for callback, processes indices [start, end) */
+typedef void (*JobRangeCallback)(size_t start, size_t end, void* context);
+
+#define JOB_WORKERS_AUTO ((size_t)-1)
+
+/** Allocate a job system
+ * @param workers number of worker threads, JOB_WORKERS_AUTO for one less than the cores,
+ * ignored on the device
+ * @return JobSystem*  JobSystem instance
+ */
+JobSystem* job_system_alloc(size_t workers);
+
+/** Free the job system, queued jobs must be waited for first
+ * @param system JobSystem instance
+ */
+void job_system_free(JobSystem* system);
+
+/** Get the number of worker threads, 0 when jobs run inline
+ * @param system JobSystem instance
+ * @return size_t  worker count
+ */
+size_t job_system_workers_get(const JobSystem* system);
+
+/** Submit a job
+ * @param system JobSystem instance
+ * @param group group the job belongs to
+ * @param callback job callback
+ * @param context job context, must stay valid until the group is waited for
+ */
+void job_submit(JobSystem* system, JobGroup* group, JobCallback callback, void* context);
+
+/** Wait for every job of the group, the caller runs queued jobs meanwhile
+ * @param system JobSystem instance
+ * @param group group to wait for
+ */
+void job_wait(JobSystem* system, JobGroup* group);
+
+/** Split [0, count) into ranges, run them as jobs and wait for all of them
+ * @param system JobSystem instance
+ * @param count number of indices
+ * @param grain minimum indices per range, 0 to choose automatically
+ * @param callback range callback
+ * @param context callback context
+ */
+void job_parallel_for(
+    JobSystem* system,
+    size_t count,
+    size_t grain,
+    JobRangeCallback callback,
+    void* context);
+
+#ifdef __cplusplus
+}
+#endif
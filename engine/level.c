@@ -1,14 +1,70 @@
 #include "level.h"
 #include "level_i.h"
 #include "entity_i.h"
-#include <m-list.h>
+#include "game_manager_i.h"
+#include "arena.h"
+#include "timer_wheel.h"
+#include <m-array.h>
+#include <m-dict.h>
 #include <furi.h>
 
-LIST_DEF(EntityList, Entity*, M_POD_OPLIST);
-#define M_OPL_EntityList_t() LIST_OPLIST(EntityList)
+ARRAY_DEF(EntityList, Entity*, M_POD_OPLIST);
+#define M_OPL_EntityList_t() ARRAY_OPLIST(EntityList, M_POD_OPLIST)
 #define FOREACH(name, list) for \
     M_EACH(name, list, EntityList_t)
 
+ARRAY_DEF(SubscriberArray, Entity*, M_POD_OPLIST);
+#define M_OPL_SubscriberArray_t() ARRAY_OPLIST(SubscriberArray, M_POD_OPLIST)
+
+DICT_DEF2(SubscriberDict, uint32_t, M_BASIC_OPLIST, SubscriberArray_t, M_OPL_SubscriberArray_t());
+
+typedef struct {
+    Entity* sender;
+    uint32_t type;
+    EntityEventValue value;
+} LevelQueuedEvent;
+
+ARRAY_DEF(EventQueue, LevelQueuedEvent, M_POD_OPLIST);
+
+DICT_DEF2(ContextPoolDict, size_t, M_BASIC_OPLIST, ArenaPool*, M_PTR_OPLIST);
+
+typedef struct {
+    Coroutine co; // first member, the Coroutine* passed to the callback points at the whole record
+    CoroutineCallback callback;
+    Entity* entity;
+    uint32_t serial; // 0 once freed
+    TimerId timer; // pending frame or ms timer
+    bool running;
+    bool stopped;
+} LevelCoroutine;
+
+// wait lists hold the serial too, so entries of stopped coroutines are recognized and skipped
+typedef struct {
+    LevelCoroutine* coroutine;
+    uint32_t serial;
+} LevelCoroutineRef;
+
+ARRAY_DEF(CoroutineArray, LevelCoroutine*, M_POD_OPLIST);
+ARRAY_DEF(CoroutineRefArray, LevelCoroutineRef, M_POD_OPLIST);
+#define M_OPL_CoroutineRefArray_t() ARRAY_OPLIST(CoroutineRefArray, M_POD_OPLIST)
+
+DICT_DEF2(
+    CoroutineWaitDict,
+    uint32_t,
+    M_BASIC_OPLIST,
+    CoroutineRefArray_t,
+    M_OPL_CoroutineRefArray_t());
+
+#define LEVEL_ARENA_BLOCK_SIZE 1024
+#define LEVEL_POOL_CHUNK_ITEMS 8
+
+// update level of detail, for entities with update_lod in their description
+#define LEVEL_LOD_NEAR 96.f // closer than this updates every frame, covers the whole screen
+#define LEVEL_LOD_FAR 192.f // beyond this updates every LEVEL_LOD_FAR_PERIOD frames
+#define LEVEL_LOD_MID_PERIOD 2 // 15 Hz at 30 fps
+#define LEVEL_LOD_FAR_PERIOD 4 // 7.5 Hz at 30 fps, also the number of stagger buckets
+#define LEVEL_LOD_CENTER ((Vector){64, 32}) // screen center, focus when no entity is set
+
 #define LEVEL_DEBUG(...) FURI_LOG_D("Level", __VA_ARGS__)
 #define LEVEL_INFO(...) FURI_LOG_I("Level", __VA_ARGS__)
 #define LEVEL_ERROR(...) FURI_LOG_E("Level", __VA_ARGS__)
@@ -21,9 +77,35 @@ struct Level {
     void* context;
     GameManager* manager;
 
+    Arena* arena;
+    ArenaPool* entity_pool;
+    ContextPoolDict_t context_pools;
+
     bool clear;
     LevelClearCallback clear_callback;
     void* clear_context;
+
+    SubscriberDict_t subscribers;
+    EventQueue_t event_queue;
+    uint32_t publish_depth;
+    bool subscribers_dirty;
+
+    Rng rng;
+    TimerWheel* timers;
+
+    ArenaPool* coroutine_pool;
+    CoroutineArray_t coroutines;
+    CoroutineRefArray_t coroutines_polling;
+    CoroutineRefArray_t coroutines_polled;
+    CoroutineWaitDict_t coroutines_waiting;
+    TimerWheel* frame_timers;
+    uint32_t frame;
+    uint32_t coroutine_serial;
+
+    Entity* update_focus;
+    float update_near;
+    float update_far;
+    uint8_t update_bucket; // stagger bucket of the next entity
 };
 
 Level* level_alloc(const LevelBehaviour* behaviour, GameManager* manager) {
@@ -33,9 +115,31 @@ Level* level_alloc(const LevelBehaviour* behaviour, GameManager* manager) {
     EntityList_init(level->entities);
     EntityList_init(level->to_add);
     EntityList_init(level->to_remove);
+    SubscriberDict_init(level->subscribers);
+    EventQueue_init(level->event_queue);
+    level->publish_depth = 0;
+    level->subscribers_dirty = false;
+    level->arena = arena_alloc(LEVEL_ARENA_BLOCK_SIZE);
+    level->entity_pool = arena_pool_alloc(level->arena, sizeof(Entity), LEVEL_POOL_CHUNK_ITEMS);
+    ContextPoolDict_init(level->context_pools);
+    level->rng = rng_split(game_manager_rng_get(manager));
+    level->timers = timer_wheel_alloc(level->arena, furi_get_tick());
+    level->coroutine_pool =
+        arena_pool_alloc(level->arena, sizeof(LevelCoroutine), LEVEL_POOL_CHUNK_ITEMS);
+    CoroutineArray_init(level->coroutines);
+    CoroutineRefArray_init(level->coroutines_polling);
+    CoroutineRefArray_init(level->coroutines_polled);
+    CoroutineWaitDict_init(level->coroutines_waiting);
+    level->frame = 0;
+    level->frame_timers = timer_wheel_alloc(level->arena, level->frame);
+    level->coroutine_serial = 0;
+    level->update_focus = NULL;
+    level->update_near = LEVEL_LOD_NEAR;
+    level->update_far = LEVEL_LOD_FAR;
+    level->update_bucket = 0;
     level->behaviour = behaviour;
     if(behaviour->context_size > 0) {
-        level->context = malloc(behaviour->context_size);
+        level->context = arena_push(level->arena, behaviour->context_size);
     } else {
         level->context = NULL;
     }
@@ -43,65 +147,144 @@ Level* level_alloc(const LevelBehaviour* behaviour, GameManager* manager) {
     return level;
 }
 
+static ArenaPool* level_context_pool_get(Level* level, size_t size) {
+    // entities with contexts of the same size share a pool
+    ArenaPool** pool = ContextPoolDict_get(level->context_pools, size);
+    if(pool) {
+        return *pool;
+    }
+
+    ArenaPool* new_pool = arena_pool_alloc(level->arena, size, LEVEL_POOL_CHUNK_ITEMS);
+    ContextPoolDict_set_at(level->context_pools, size, new_pool);
+    return new_pool;
+}
+
+static Entity* level_entity_alloc(Level* level, const EntityDescription* description) {
+    Entity* entity = arena_pool_get(level->entity_pool);
+    void* context = NULL;
+    if(description && description->context_size > 0) {
+        context = arena_pool_get(level_context_pool_get(level, description->context_size));
+    }
+    entity_init(entity, description, context);
+    entity->update_bucket = level->update_bucket;
+    level->update_bucket = (level->update_bucket + 1) % LEVEL_LOD_FAR_PERIOD;
+    game_manager_entities_count_add(level->manager, 1);
+    return entity;
+}
+
+static void level_entity_free(Level* level, Entity* entity) {
+    const EntityDescription* description = entity->description;
+    void* context = entity->context;
+    entity_deinit(entity);
+    game_manager_entities_count_add(level->manager, -1);
+    if(context) {
+        arena_pool_put(level_context_pool_get(level, description->context_size), context);
+    }
+    arena_pool_put(level->entity_pool, entity);
+}
+
 static void level_process_add(Level* level) {
     // move entities from to_add to entities
     FOREACH(item, level->to_add) {
         EntityList_push_back(level->entities, *item);
     }
-    EntityList_clear(level->to_add);
+    EntityList_reset(level->to_add);
 }
 
+static void level_process_events(Level* level);
+
+static void level_stop_entity_coroutines(Level* level, Entity* entity);
+
+static void level_wake_coroutines(Level* level, uint32_t type, EntityEventValue value);
+
+static void level_process_coroutines(Level* level);
+
+static void level_unsubscribe_entity(Level* level, Entity* entity);
+
 static void level_process_remove(Level* level) {
-    // remove entities in to_remove from entities and free them
-    FOREACH(item, level->to_remove) {
-        entity_free(*item);
-        EntityList_it_t it;
-
-        // find and remove the entity from the entities list
-        for(EntityList_it(it, level->entities); !EntityList_end_p(it); EntityList_next(it)) {
-            if(*EntityList_ref(it) == *item) {
-                EntityList_remove(level->entities, it);
-                break;
-            }
-        }
+    if(EntityList_empty_p(level->to_remove)) {
+        return;
     }
-    EntityList_clear(level->to_remove);
-}
 
-static bool level_entity_in_list_p(const EntityList_t list, Entity* entity) {
-    FOREACH(item, list) {
-        if(*item == entity) {
-            return true;
+    // deliver queued events before any sender or receiver is freed
+    if(!EventQueue_empty_p(level->event_queue)) {
+        level_process_events(level);
+        // handlers can add entities and remove them again, those have to be in entities
+        // for the pass below to find them
+        level_process_add(level);
+    }
+
+    // every entity in to_remove is already in entities and marked as removed,
+    // so a single compacting pass frees them all
+    size_t kept = 0;
+    for(size_t i = 0; i < EntityList_size(level->entities); i++) {
+        Entity* entity = *EntityList_get(level->entities, i);
+        if(entity->removed) {
+            if(entity == level->update_focus) {
+                level->update_focus = NULL;
+            }
+            level_unsubscribe_entity(level, entity);
+            level_entity_free(level, entity);
+        } else {
+            EntityList_set_at(level->entities, kept++, entity);
         }
     }
-    return false;
+    EntityList_resize(level->entities, kept);
+    EntityList_reset(level->to_remove);
 }
 
 static void level_clear_entities(Level* level) {
     size_t iterations = 0;
+    size_t stopped = 0;
 
-    do {
-        // process to_add and to_remove
-        level_process_add(level);
-        level_process_remove(level);
+    // queued events would only reach entities that are about to be stopped
+    EventQueue_reset(level->event_queue);
 
-        // remove entities from entities list
-        FOREACH(item, level->entities) {
-            if(!level_entity_in_list_p(level->to_remove, *item)) {
-                level_remove_entity(level, *item);
+    level_process_add(level);
+
+    // stop every entity once, entity_call_stop can call level_add_entity or
+    // level_remove_entity, so keep going until no new entities show up
+    while(stopped < EntityList_size(level->entities)) {
+        for(; stopped < EntityList_size(level->entities); stopped++) {
+            Entity* entity = *EntityList_get(level->entities, stopped);
+            if(!entity->removed) {
+                entity->removed = true;
+                entity_call_stop(entity, level->manager);
             }
         }
 
+        // collect entities spawned by stop callbacks in one batch
+        level_process_add(level);
+
         // check if we are looping too many times
         iterations++;
         if(iterations >= 100) {
-            LEVEL_ERROR("Level free looped too many times");
+            LEVEL_ERROR("Level clear looped too many times");
         }
+    }
 
-        // entity_call_stop can call level_remove_entity or level_add_entity
-        // so we need to process to_add and to_remove again
-    } while(!EntityList_empty_p(level->to_add) || !EntityList_empty_p(level->to_remove) ||
-            !EntityList_empty_p(level->entities));
+    // nothing is running anymore, drop everything at once
+    FOREACH(item, level->entities) {
+        entity_deinit(*item);
+    }
+    game_manager_entities_count_add(level->manager, -(int32_t)EntityList_size(level->entities));
+    arena_pool_reset(level->entity_pool);
+    ContextPoolDict_it_t it;
+    for(ContextPoolDict_it(it, level->context_pools); !ContextPoolDict_end_p(it);
+        ContextPoolDict_next(it)) {
+        arena_pool_reset(ContextPoolDict_ref(it)->value);
+    }
+    EntityList_reset(level->entities);
+    EntityList_reset(level->to_remove);
+    level->update_focus = NULL;
+    timer_wheel_reset(level->timers);
+    timer_wheel_reset(level->frame_timers);
+    arena_pool_reset(level->coroutine_pool);
+    CoroutineArray_reset(level->coroutines);
+    CoroutineRefArray_reset(level->coroutines_polling);
+    CoroutineWaitDict_reset(level->coroutines_waiting);
+    SubscriberDict_reset(level->subscribers);
+    level->subscribers_dirty = false;
 }
 
 void level_free(Level* level) {
@@ -110,23 +293,40 @@ void level_free(Level* level) {
     EntityList_clear(level->entities);
     EntityList_clear(level->to_add);
     EntityList_clear(level->to_remove);
+    SubscriberDict_clear(level->subscribers);
+    EventQueue_clear(level->event_queue);
+    ContextPoolDict_clear(level->context_pools);
+    CoroutineArray_clear(level->coroutines);
+    CoroutineRefArray_clear(level->coroutines_polling);
+    CoroutineRefArray_clear(level->coroutines_polled);
+    CoroutineWaitDict_clear(level->coroutines_waiting);
 
-    if(level->behaviour->context_size > 0) {
-        free(level->context);
-    }
+    // level context, entities and their contexts all live in the arena
+    arena_free(level->arena);
 
     LEVEL_DEBUG("Freeing level at %p", level);
     free(level);
 }
 
 Entity* level_add_entity(Level* level, const EntityDescription* description) {
-    Entity* entity = entity_alloc(description);
+    Entity* entity = level_entity_alloc(level, description);
     EntityList_push_back(level->to_add, entity);
     entity_call_start(entity, level->manager);
     return entity;
 }
 
 void level_remove_entity(Level* level, Entity* entity) {
+    if(entity->removed) {
+        return;
+    }
+    entity->removed = true;
+    if(entity->timers > 0) {
+        timer_wheel_cancel_owner(level->timers, entity);
+        entity->timers = 0;
+    }
+    if(entity->coroutines > 0) {
+        level_stop_entity_coroutines(level, entity);
+    }
     EntityList_push_back(level->to_remove, entity);
     entity_call_stop(entity, level->manager);
 }
@@ -143,45 +343,204 @@ void level_send_event(
         }
     }
 
-    FOREACH(item, level->to_add) {
-        if(receiver_desc == entity_description_get(*item) || receiver_desc == NULL) {
-            entity_send_event(sender, *item, level->manager, type, value);
+    // event handlers can add entities, so to_add can grow while we walk it
+    for(size_t i = 0; i < EntityList_size(level->to_add); i++) {
+        Entity* entity = *EntityList_get(level->to_add, i);
+        if(receiver_desc == entity_description_get(entity) || receiver_desc == NULL) {
+            entity_send_event(sender, entity, level->manager, type, value);
+        }
+    }
+}
+
+void level_subscribe_event(Level* level, Entity* entity, uint32_t type) {
+    SubscriberArray_t* subscribers = SubscriberDict_safe_get(level->subscribers, type);
+
+    for(size_t i = 0; i < SubscriberArray_size(*subscribers); i++) {
+        if(*SubscriberArray_get(*subscribers, i) == entity) {
+            return;
+        }
+    }
+
+    SubscriberArray_push_back(*subscribers, entity);
+    entity->subscriptions++;
+}
+
+static bool level_unsubscribe_from(Level* level, SubscriberArray_t subscribers, Entity* entity) {
+    for(size_t i = 0; i < SubscriberArray_size(subscribers); i++) {
+        if(*SubscriberArray_get(subscribers, i) == entity) {
+            if(level->publish_depth > 0) {
+                // publishing iterates this array by index, leave a hole and compact later
+                SubscriberArray_set_at(subscribers, i, NULL);
+                level->subscribers_dirty = true;
+            } else {
+                SubscriberArray_erase(subscribers, i);
+            }
+            entity->subscriptions--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void level_unsubscribe_event(Level* level, Entity* entity, uint32_t type) {
+    SubscriberArray_t* subscribers = SubscriberDict_get(level->subscribers, type);
+    if(subscribers) {
+        level_unsubscribe_from(level, *subscribers, entity);
+    }
+}
+
+static void level_unsubscribe_entity(Level* level, Entity* entity) {
+    if(entity->subscriptions == 0) {
+        return;
+    }
+
+    SubscriberDict_it_t it;
+    for(SubscriberDict_it(it, level->subscribers); !SubscriberDict_end_p(it);
+        SubscriberDict_next(it)) {
+        level_unsubscribe_from(level, SubscriberDict_ref(it)->value, entity);
+        if(entity->subscriptions == 0) {
+            break;
         }
     }
 }
 
+static void level_compact_subscribers(Level* level) {
+    SubscriberDict_it_t it;
+    for(SubscriberDict_it(it, level->subscribers); !SubscriberDict_end_p(it);
+        SubscriberDict_next(it)) {
+        SubscriberArray_ptr subscribers = SubscriberDict_ref(it)->value;
+        size_t kept = 0;
+        for(size_t i = 0; i < SubscriberArray_size(subscribers); i++) {
+            Entity* entity = *SubscriberArray_get(subscribers, i);
+            if(entity) {
+                SubscriberArray_set_at(subscribers, kept++, entity);
+            }
+        }
+        SubscriberArray_resize(subscribers, kept);
+    }
+    level->subscribers_dirty = false;
+}
+
+void level_publish_event(Level* level, Entity* sender, uint32_t type, EntityEventValue value) {
+    level_wake_coroutines(level, type, value);
+
+    SubscriberArray_t* subscribers = SubscriberDict_get(level->subscribers, type);
+    if(!subscribers) {
+        return;
+    }
+
+    // entities subscribed by the handlers will get the next event, not this one
+    size_t count = SubscriberArray_size(*subscribers);
+
+    level->publish_depth++;
+    for(size_t i = 0; i < count; i++) {
+        // a handler may subscribe to a new type and grow the dictionary, so look it up every time
+        subscribers = SubscriberDict_get(level->subscribers, type);
+        Entity* receiver = *SubscriberArray_get(*subscribers, i);
+        if(receiver) {
+            entity_send_event(sender, receiver, level->manager, type, value);
+        }
+    }
+    level->publish_depth--;
+
+    if(level->publish_depth == 0 && level->subscribers_dirty) {
+        level_compact_subscribers(level);
+    }
+}
+
+void level_post_event(Level* level, Entity* sender, uint32_t type, EntityEventValue value) {
+    LevelQueuedEvent event = {
+        .sender = sender,
+        .type = type,
+        .value = value,
+    };
+    EventQueue_push_back(level->event_queue, event);
+}
+
+static void level_process_events(Level* level) {
+    // events posted by the handlers are delivered on the next pass
+    size_t count = EventQueue_size(level->event_queue);
+    for(size_t i = 0; i < count; i++) {
+        LevelQueuedEvent event = *EventQueue_get(level->event_queue, i);
+        level_publish_event(level, event.sender, event.type, event.value);
+    }
+    EventQueue_remove_v(level->event_queue, 0, count);
+}
+
+static bool level_update_due(Level* level, Entity* entity, Vector focus) {
+    float dx = entity->position.x - focus.x;
+    float dy = entity->position.y - focus.y;
+    float distance_squared = dx * dx + dy * dy;
+    if(distance_squared < level->update_near * level->update_near) {
+        return true;
+    }
+
+    // buckets spread entities of a tier over its period, so they do not all update on one frame
+    uint32_t period = distance_squared < level->update_far * level->update_far ?
+                          LEVEL_LOD_MID_PERIOD :
+                          LEVEL_LOD_FAR_PERIOD;
+    return (level->frame + entity->update_bucket) % period == 0;
+}
+
 static void level_process_update(Level* level, GameManager* manager) {
+    float delta = game_engine_get_delta_time(game_manager_engine_get(manager));
+    Vector focus = level->update_focus ? level->update_focus->position : LEVEL_LOD_CENTER;
+
+    // every entity updates every frame, so positions tied to the camera never go stale,
+    // level of detail only says when the expensive part of an update is due
+    FOREACH(item, level->entities) {
+        Entity* entity = *item;
+        entity->update_pending += delta;
+        entity->update_due = !entity->description || !entity->description->update_lod ||
+                             level_update_due(level, entity, focus);
+        if(entity->update_due) {
+            entity->update_delta = entity->update_pending;
+            entity->update_pending = 0;
+        } else {
+            entity->update_delta = 0;
+        }
+    }
+
+    const EntityRegistry* registry = game_manager_entity_registry_get(manager);
+    if(registry) {
+        if(!EntityList_empty_p(level->entities)) {
+            registry->update(
+                EntityList_cget(level->entities, 0), EntityList_size(level->entities), manager);
+        }
+        return;
+    }
+
     FOREACH(item, level->entities) {
         entity_call_update(*item, manager);
     }
 }
 
 static void level_process_collision(Level* level, GameManager* manager) {
-    EntityList_it_t it_first;
-    EntityList_it_t it_second;
+    const EntityRegistry* registry = game_manager_entity_registry_get(manager);
+    size_t count = EntityList_size(level->entities);
 
-    EntityList_it(it_first, level->entities);
-    while(!EntityList_end_p(it_first)) {
-        Entity* first = *EntityList_ref(it_first);
+    for(size_t i = 0; i < count; i++) {
+        Entity* first = *EntityList_get(level->entities, i);
         if(entity_collider_exists(first)) {
-            // start second iterator at the next entity,
+            // start second index at the next entity,
             // so we don't check the same pair twice
-            EntityList_it_set(it_second, it_first);
-            EntityList_next(it_second);
-            while(!EntityList_end_p(it_second)) {
-                Entity* second = *EntityList_ref(it_second);
+            for(size_t j = i + 1; j < count; j++) {
+                Entity* second = *EntityList_get(level->entities, j);
                 if(first->collider_dirty || second->collider_dirty) {
                     if(entity_collider_exists(second)) {
                         if(entity_collider_check_collision(first, second)) {
-                            entity_call_collision(first, second, manager);
-                            entity_call_collision(second, first, manager);
+                            if(registry) {
+                                registry->collision(first, second, manager);
+                                registry->collision(second, first, manager);
+                            } else {
+                                entity_call_collision(first, second, manager);
+                                entity_call_collision(second, first, manager);
+                            }
                         }
                     }
                 }
-                EntityList_next(it_second);
             }
         }
-        EntityList_next(it_first);
     }
 
     FOREACH(item, level->entities) {
@@ -189,6 +548,16 @@ static void level_process_collision(Level* level, GameManager* manager) {
     }
 }
 
+void level_update_focus_set(Level* level, Entity* entity) {
+    level->update_focus = entity;
+}
+
+void level_update_lod_set(Level* level, float near, float far) {
+    furi_check(near <= far);
+    level->update_near = near;
+    level->update_far = far;
+}
+
 void level_clear(Level* level, LevelClearCallback callback, void* context) {
     level->clear_callback = callback;
     level->clear_context = context;
@@ -204,11 +573,26 @@ void level_update(Level* level, GameManager* manager) {
 
     level_process_add(level);
     level_process_remove(level);
+    timer_wheel_advance(level->timers, furi_get_tick(), level);
+    level_process_coroutines(level);
     level_process_update(level, manager);
     level_process_collision(level, manager);
+    level_process_events(level);
 }
 
 void level_render(Level* level, GameManager* manager, Canvas* canvas) {
+    const EntityRegistry* registry = game_manager_entity_registry_get(manager);
+    if(registry) {
+        if(!EntityList_empty_p(level->entities)) {
+            registry->render(
+                EntityList_cget(level->entities, 0),
+                EntityList_size(level->entities),
+                manager,
+                canvas);
+        }
+        return;
+    }
+
     FOREACH(item, level->entities) {
         entity_call_render(*item, manager, canvas);
     }
@@ -242,21 +626,18 @@ size_t level_entity_count(const Level* level, const EntityDescription* descripti
     size_t count = 0;
     FOREACH(item, level->entities) {
         if(description == NULL || description == entity_description_get(*item)) {
-            count++;
-        }
-    }
-
-    // subtract entities that are in to_remove
-    FOREACH(item, level->to_remove) {
-        if(description == NULL || description == entity_description_get(*item)) {
-            count--;
+            if(!(*item)->removed) {
+                count++;
+            }
         }
     }
 
     // add entities that are in to_add
     FOREACH(item, level->to_add) {
         if(description == NULL || description == entity_description_get(*item)) {
-            count++;
+            if(!(*item)->removed) {
+                count++;
+            }
         }
     }
 
@@ -267,7 +648,7 @@ Entity* level_entity_get(const Level* level, const EntityDescription* descriptio
     size_t count = 0;
     FOREACH(item, level->entities) {
         if(description == NULL || description == entity_description_get(*item)) {
-            if(!level_entity_in_list_p(level->to_remove, *item)) {
+            if(!(*item)->removed) {
                 if(count == index) {
                     return *item;
                 }
@@ -278,7 +659,7 @@ Entity* level_entity_get(const Level* level, const EntityDescription* descriptio
 
     FOREACH(item, level->to_add) {
         if(description == NULL || description == entity_description_get(*item)) {
-            if(!level_entity_in_list_p(level->to_remove, *item)) {
+            if(!(*item)->removed) {
                 if(count == index) {
                     return *item;
                 }
@@ -294,6 +675,227 @@ void* level_context_get(Level* level) {
     return level->context;
 }
 
+static void level_timer_callback(void* context, void* owner, uint32_t type, TimerId id, bool done) {
+    Level* level = context;
+    Entity* entity = owner;
+    if(done) {
+        entity->timers--;
+    }
+    entity_send_event(NULL, entity, level->manager, type, (EntityEventValue){.value = id});
+}
+
+TimerId level_timer_start(
+    Level* level,
+    Entity* entity,
+    uint32_t type,
+    uint32_t delay_ms,
+    uint32_t period_ms) {
+    furi_check(!entity->removed, "Timer for a removed entity");
+    entity->timers++;
+    return timer_wheel_schedule(
+        level->timers, delay_ms, period_ms, level_timer_callback, entity, type);
+}
+
+bool level_timer_stop(Level* level, TimerId timer) {
+    Entity* entity = timer_wheel_cancel(level->timers, timer);
+    if(entity) {
+        entity->timers--;
+    }
+    return entity != NULL;
+}
+
+static void level_coroutine_resume(Level* level, LevelCoroutine* coroutine);
+
+static void level_coroutine_free(Level* level, LevelCoroutine* coroutine) {
+    for(size_t i = 0; i < CoroutineArray_size(level->coroutines); i++) {
+        if(*CoroutineArray_get(level->coroutines, i) == coroutine) {
+            CoroutineArray_erase(level->coroutines, i);
+            break;
+        }
+    }
+    coroutine->entity->coroutines--;
+    coroutine->serial = 0;
+    arena_pool_put(level->coroutine_pool, coroutine);
+}
+
+static void level_coroutine_timer_callback(
+    void* context,
+    void* owner,
+    uint32_t value,
+    TimerId id,
+    bool done) {
+    UNUSED(value);
+    UNUSED(id);
+    UNUSED(done);
+    LevelCoroutine* coroutine = owner;
+    coroutine->timer = TIMER_ID_NONE;
+    level_coroutine_resume(context, coroutine);
+}
+
+static void level_coroutine_resume(Level* level, LevelCoroutine* coroutine) {
+    Entity* entity = coroutine->entity;
+    coroutine->co.wait = CoroutineWaitNone;
+    coroutine->running = true;
+    coroutine->callback(&coroutine->co, entity, level->manager, entity->context);
+    coroutine->running = false;
+
+    if(coroutine->stopped) {
+        level_coroutine_free(level, coroutine);
+        return;
+    }
+
+    // park the coroutine where the thing it waits for will find it
+    LevelCoroutineRef ref = {.coroutine = coroutine, .serial = coroutine->serial};
+    switch(coroutine->co.wait) {
+    case CoroutineWaitFrames:
+        coroutine->timer = timer_wheel_schedule(
+            level->frame_timers, coroutine->co.arg, 0, level_coroutine_timer_callback, coroutine, 0);
+        break;
+    case CoroutineWaitMs:
+        coroutine->timer = timer_wheel_schedule(
+            level->timers, coroutine->co.arg, 0, level_coroutine_timer_callback, coroutine, 0);
+        break;
+    case CoroutineWaitEvent:
+        CoroutineRefArray_push_back(
+            *CoroutineWaitDict_safe_get(level->coroutines_waiting, coroutine->co.arg), ref);
+        break;
+    case CoroutineWaitCondition:
+        CoroutineRefArray_push_back(level->coroutines_polling, ref);
+        break;
+    default:
+        level_coroutine_free(level, coroutine);
+        break;
+    }
+}
+
+static void level_coroutine_unpark(CoroutineRefArray_t refs, const LevelCoroutine* coroutine) {
+    for(size_t i = 0; i < CoroutineRefArray_size(refs); i++) {
+        if(CoroutineRefArray_get(refs, i)->coroutine == coroutine) {
+            CoroutineRefArray_erase(refs, i);
+            return;
+        }
+    }
+}
+
+static void level_coroutine_stop_internal(Level* level, LevelCoroutine* coroutine) {
+    if(coroutine->running) {
+        // stopping itself, freed when its callback returns
+        coroutine->stopped = true;
+        return;
+    }
+
+    // take it off whatever it is parked on, or stopped coroutines pile up on event types that never come
+    if(coroutine->timer != TIMER_ID_NONE) {
+        TimerWheel* wheel = coroutine->co.wait == CoroutineWaitFrames ? level->frame_timers :
+                                                                         level->timers;
+        timer_wheel_cancel(wheel, coroutine->timer);
+    } else if(coroutine->co.wait == CoroutineWaitEvent) {
+        CoroutineRefArray_t* waiting =
+            CoroutineWaitDict_get(level->coroutines_waiting, coroutine->co.arg);
+        if(waiting) {
+            level_coroutine_unpark(*waiting, coroutine);
+        }
+    } else if(coroutine->co.wait == CoroutineWaitCondition) {
+        // while conditions are being polled it is in coroutines_polled, the serial check skips it there
+        level_coroutine_unpark(level->coroutines_polling, coroutine);
+    }
+    level_coroutine_free(level, coroutine);
+}
+
+static void level_stop_entity_coroutines(Level* level, Entity* entity) {
+    // backwards, stopping erases from the array
+    for(size_t i = CoroutineArray_size(level->coroutines); i > 0; i--) {
+        LevelCoroutine* coroutine = *CoroutineArray_get(level->coroutines, i - 1);
+        if(coroutine->entity == entity) {
+            level_coroutine_stop_internal(level, coroutine);
+        }
+    }
+}
+
+static void level_wake_coroutines(Level* level, uint32_t type, EntityEventValue value) {
+    CoroutineRefArray_t* waiting = CoroutineWaitDict_get(level->coroutines_waiting, type);
+    if(!waiting || CoroutineRefArray_empty_p(*waiting)) {
+        return;
+    }
+
+    // coroutines that wait for the same type again get the next event, not this one
+    CoroutineRefArray_t woken;
+    CoroutineRefArray_init_move(woken, *waiting);
+    CoroutineRefArray_init(*waiting);
+
+    for(size_t i = 0; i < CoroutineRefArray_size(woken); i++) {
+        LevelCoroutineRef ref = *CoroutineRefArray_get(woken, i);
+        if(ref.coroutine->serial == ref.serial) {
+            ref.coroutine->co.event = value;
+            level_coroutine_resume(level, ref.coroutine);
+        }
+    }
+    CoroutineRefArray_clear(woken);
+}
+
+static void level_process_coroutines(Level* level) {
+    level->frame++;
+    timer_wheel_advance(level->frame_timers, level->frame, level);
+
+    if(CoroutineRefArray_empty_p(level->coroutines_polling)) {
+        return;
+    }
+
+    // conditions are checked once per update, coroutines that keep waiting go back to the list
+    CoroutineRefArray_swap(level->coroutines_polling, level->coroutines_polled);
+    for(size_t i = 0; i < CoroutineRefArray_size(level->coroutines_polled); i++) {
+        LevelCoroutineRef ref = *CoroutineRefArray_get(level->coroutines_polled, i);
+        if(ref.coroutine->serial == ref.serial) {
+            level_coroutine_resume(level, ref.coroutine);
+        }
+    }
+    CoroutineRefArray_reset(level->coroutines_polled);
+}
+
+CoroutineId level_coroutine_start(Level* level, Entity* entity, CoroutineCallback callback) {
+    furi_check(!entity->removed, "Coroutine for a removed entity");
+
+    LevelCoroutine* coroutine = arena_pool_get(level->coroutine_pool);
+    coroutine->callback = callback;
+    coroutine->entity = entity;
+    coroutine->timer = TIMER_ID_NONE;
+    coroutine->serial = ++level->coroutine_serial;
+    if(coroutine->serial == 0) {
+        coroutine->serial = ++level->coroutine_serial;
+    }
+    coroutine->co.id = coroutine->serial;
+    entity->coroutines++;
+    CoroutineArray_push_back(level->coroutines, coroutine);
+
+    // runs up to its first wait right away
+    uint32_t serial = coroutine->serial;
+    level_coroutine_resume(level, coroutine);
+    return coroutine->serial == serial ? serial : COROUTINE_ID_NONE;
+}
+
+bool level_coroutine_stop(Level* level, CoroutineId id) {
+    if(id == COROUTINE_ID_NONE) {
+        return false;
+    }
+    // by serial, a pointer could already belong to a newer coroutine from the pool
+    for(size_t i = 0; i < CoroutineArray_size(level->coroutines); i++) {
+        LevelCoroutine* coroutine = *CoroutineArray_get(level->coroutines, i);
+        if(coroutine->serial == id) {
+            level_coroutine_stop_internal(level, coroutine);
+            return true;
+        }
+    }
+    return false;
+}
+
+Rng* level_rng_get(Level* level) {
+    return &level->rng;
+}
+
+Arena* level_arena_get(Level* level) {
+    return level->arena;
+}
+
 bool level_contains_entity(const Level* level, const Entity* entity) {
     FOREACH(item, level->entities) {
         if(*item == entity) {
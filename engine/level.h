@@ -1,6 +1,10 @@
 #pragma once
 #include <stddef.h>
 #include "entity.h"
+#include "arena.h"
+#include "rng.h"
+#include "timer_wheel.h"
+#include "coroutine.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +41,28 @@ void level_clear(Level* level, LevelClearCallback callback, void* context);
  */
 Entity* level_add_entity(Level* level, const EntityDescription* behaviour);
 
+/**
+ * @brief Set the entity that update level of detail is measured from
+ * Entities with update_lod in their description are due every frame near the focus and less
+ * often further away, see entity_update_due and level_update_lod_set. They still update every
+ * frame. The focus is dropped when it is removed.
+ * 
+ * @param level level instance
+ * @param entity focus entity, NULL for the screen center
+ */
+void level_update_focus_set(Level* level, Entity* entity);
+
+/**
+ * @brief Set the distances of the update level of detail tiers
+ * Up to near from the focus entities are due every frame, up to far every 2nd frame, beyond
+ * that every 4th, in staggered buckets. Defaults to 96 and 192, which covers the whole screen.
+ * 
+ * @param level level instance
+ * @param near distance of the every frame tier
+ * @param far distance beyond which the slowest tier starts
+ */
+void level_update_lod_set(Level* level, float near, float far);
+
 /**
  * @brief Remove an entity from the level
  * 
@@ -61,6 +87,97 @@ void level_send_event(
     uint32_t type,
     EntityEventValue value);
 
+/**
+ * @brief Subscribe an entity to an event type
+ * Subscriptions are dropped automatically when the entity is removed from the level
+ * 
+ * @param level level instance
+ * @param entity entity that will receive the events
+ * @param type event type
+ */
+void level_subscribe_event(Level* level, Entity* entity, uint32_t type);
+
+/**
+ * @brief Unsubscribe an entity from an event type
+ * 
+ * @param level level instance
+ * @param entity subscribed entity
+ * @param type event type
+ */
+void level_unsubscribe_event(Level* level, Entity* entity, uint32_t type);
+
+/**
+ * @brief Send an event to the entities subscribed to its type, right now
+ * Cost depends only on the number of subscribers, not on the number of entities in the level
+ * 
+ * @param level level instance
+ * @param sender entity that sends the event, can be NULL
+ * @param type event type
+ * @param value event value
+ */
+void level_publish_event(Level* level, Entity* sender, uint32_t type, EntityEventValue value);
+
+/**
+ * @brief Queue an event for the entities subscribed to its type
+ * Queued events are delivered in order at the end of the level update, after collisions
+ * 
+ * @param level level instance
+ * @param sender entity that sends the event, can be NULL
+ * @param type event type
+ * @param value event value
+ */
+void level_post_event(Level* level, Entity* sender, uint32_t type, EntityEventValue value);
+
+/**
+ * @brief Start a timer that sends an event to an entity
+ * The entity receives an event of the given type, with the timer id as value and no sender.
+ * Timers are stopped automatically when the entity is removed from the level
+ * 
+ * @param level level instance
+ * @param entity entity that will receive the event
+ * @param type event type
+ * @param delay_ms time until the first event
+ * @param period_ms time between repeated events, 0 for a single event
+ * @return TimerId timer id
+ */
+TimerId level_timer_start(
+    Level* level,
+    Entity* entity,
+    uint32_t type,
+    uint32_t delay_ms,
+    uint32_t period_ms);
+
+/**
+ * @brief Stop a timer
+ * 
+ * @param level level instance
+ * @param timer timer id
+ * @return true if the timer was still pending
+ */
+bool level_timer_stop(Level* level, TimerId timer);
+
+/**
+ * @brief Start a coroutine for an entity, see coroutine.h
+ * The coroutine runs up to its first wait right away, then the level resumes it when the wait is over.
+ * Coroutines are stopped automatically when the entity is removed from the level
+ * 
+ * @param level level instance
+ * @param entity entity the coroutine belongs to, its context is passed to the callback
+ * @param callback coroutine function
+ * @return CoroutineId coroutine id, COROUTINE_ID_NONE if it finished before its first wait
+ */
+CoroutineId level_coroutine_start(Level* level, Entity* entity, CoroutineCallback callback);
+
+/**
+ * @brief Stop a coroutine, can be called by the coroutine itself with co->id
+ * Ids of finished or stopped coroutines are never reused, stopping one again does nothing
+ * 
+ * @param level level instance
+ * @param id coroutine id
+ * @return true if the coroutine was still running
+ */
+bool level_coroutine_stop(Level* level, CoroutineId id);
+
 /**
  * @brief Get the count of entities of a certain type in the level, or all entities if description is NULL
  * 
@@ -89,6 +206,24 @@ Entity* level_entity_get(const Level* level, const EntityDescription* descriptio
  */
 void* level_context_get(Level* level);
 
+/**
+ * @brief Get the arena of the level
+ * Memory allocated from it lives as long as the level and is released in one go when the level is freed
+ * 
+ * @param level level instance
+ * @return Arena* arena
+ */
+Arena* level_arena_get(Level* level);
+
+/**
+ * @brief Get the random stream of the level
+ * Split from the game manager stream when the level is added, entities can split their own from it
+ * 
+ * @param level level instance
+ * @return Rng* random stream
+ */
+Rng* level_rng_get(Level* level);
+
 /**
  * @brief Check if the level contains an entity
  * 
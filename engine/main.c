@@ -13,42 +13,47 @@ static void frame_cb(GameEngine* engine, Canvas* canvas, InputState input, void*
     game_manager_render(game_manager, canvas);
 }
 
-int32_t game_app(void* p) {
-    UNUSED(p);
+int32_t game_run(const Game* game) {
     GameManager* game_manager = game_manager_alloc();
 
     GameEngineSettings settings = game_engine_settings_init();
-    settings.target_fps = game.target_fps;
-    settings.show_fps = game.show_fps;
-    settings.always_backlight = game.always_backlight;
+    settings.target_fps = game->target_fps;
+    settings.show_fps = game->show_fps;
+    settings.always_backlight = game->always_backlight;
     settings.frame_callback = frame_cb;
     settings.context = game_manager;
 
     GameEngine* engine = game_engine_alloc(settings);
     game_manager_engine_set(game_manager, engine);
+    game_manager_entity_registry_set(game_manager, game->entity_registry);
 
     void* game_context = NULL;
-    if(game.context_size > 0) {
-        game_context = malloc(game.context_size);
+    if(game->context_size > 0) {
+        game_context = malloc(game->context_size);
         game_manager_game_context_set(game_manager, game_context);
     }
-    game.start(game_manager, game_context);
+    game->start(game_manager, game_context);
 
     game_engine_run(engine);
     game_engine_free(engine);
 
-    game_manager_free(game_manager);
+    int32_t entities = game_manager_free(game_manager);
 
-    game.stop(game_context);
+    game->stop(game_context);
     if(game_context) {
         free(game_context);
     }
 
-    int32_t entities = entities_get_count();
     if(entities != 0) {
         FURI_LOG_E("Game", "Memory leak detected: %ld entities still allocated", entities);
         return -1;
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+int32_t game_app(void* p) {
+    UNUSED(p);
+    // the only use of the `game` symbol, the rest of the engine gets the game passed in
+    return game_run(&game);
+}
@@ -0,0 +1,149 @@
+#include "quality.h"
+#include <furi.h>
+
+#define TAG "Quality"
+
+#define QUALITY_WINDOW 8 // frames averaged, power of two
+#define QUALITY_OVERLOAD_PERCENT 95 // lower a knob above this share of the budget
+#define QUALITY_HEADROOM_PERCENT 70 // raise a knob below this share of the budget...
+#define QUALITY_HEADROOM_FRAMES 60 // ...for this many frames in a row
+#define QUALITY_SETTLE_FRAMES QUALITY_WINDOW // frames to wait after a change
+
+typedef struct {
+    const char* name;
+    int32_t full;
+    int32_t lowest;
+    int32_t step;
+    int32_t value;
+} QualityKnobState;
+
+struct QualityGovernor {
+    uint32_t budget_us;
+    uint32_t window[QUALITY_WINDOW];
+    uint32_t window_sum;
+    uint8_t window_index;
+    uint8_t settle;
+    uint16_t headroom;
+    uint16_t steps_down;
+
+    QualityKnobState knobs[QUALITY_KNOBS_MAX];
+    uint8_t knobs_count;
+};
+
+QualityGovernor* quality_governor_alloc(uint32_t budget_us) {
+    QualityGovernor* governor = malloc(sizeof(QualityGovernor));
+    memset(governor, 0, sizeof(QualityGovernor));
+    governor->budget_us = budget_us;
+    governor->settle = QUALITY_WINDOW; // fill the window before judging
+    return governor;
+}
+
+void quality_governor_free(QualityGovernor* governor) {
+    free(governor);
+}
+
+QualityKnob quality_governor_knob_add(
+    QualityGovernor* governor,
+    const char* name,
+    int32_t full,
+    int32_t lowest,
+    int32_t step) {
+    furi_check(governor->knobs_count < QUALITY_KNOBS_MAX, "Too many quality knobs");
+    furi_check(step > 0);
+
+    QualityKnobState* knob = &governor->knobs[governor->knobs_count];
+    knob->name = name;
+    knob->full = full;
+    knob->lowest = lowest;
+    knob->step = step;
+    knob->value = full;
+    return governor->knobs_count++;
+}
+
+int32_t quality_governor_knob_get(const QualityGovernor* governor, QualityKnob knob) {
+    furi_check(knob < governor->knobs_count);
+    return governor->knobs[knob].value;
+}
+
+static bool quality_knob_lower(QualityKnobState* knob) {
+    if(knob->value == knob->lowest) return false;
+
+    if(knob->lowest < knob->full) {
+        knob->value = MAX(knob->value - knob->step, knob->lowest);
+    } else {
+        knob->value = MIN(knob->value + knob->step, knob->lowest);
+    }
+    return true;
+}
+
+static bool quality_knob_raise(QualityKnobState* knob) {
+    if(knob->value == knob->full) return false;
+
+    if(knob->lowest < knob->full) {
+        knob->value = MIN(knob->value + knob->step, knob->full);
+    } else {
+        knob->value = MAX(knob->value - knob->step, knob->full);
+    }
+    return true;
+}
+
+static void quality_governor_lower(QualityGovernor* governor) {
+    for(uint8_t i = 0; i < governor->knobs_count; i++) {
+        QualityKnobState* knob = &governor->knobs[i];
+        if(quality_knob_lower(knob)) {
+            governor->steps_down++;
+            FURI_LOG_D(TAG, "%s down to %ld", knob->name, knob->value);
+            return;
+        }
+    }
+}
+
+static void quality_governor_raise(QualityGovernor* governor) {
+    for(uint8_t i = governor->knobs_count; i > 0; i--) {
+        QualityKnobState* knob = &governor->knobs[i - 1];
+        if(quality_knob_raise(knob)) {
+            governor->steps_down--;
+            FURI_LOG_D(TAG, "%s up to %ld", knob->name, knob->value);
+            return;
+        }
+    }
+}
+
+void quality_governor_frame(QualityGovernor* governor, uint32_t frame_us) {
+    governor->window_sum -= governor->window[governor->window_index];
+    governor->window[governor->window_index] = frame_us;
+    governor->window_sum += frame_us;
+    governor->window_index = (governor->window_index + 1) % QUALITY_WINDOW;
+
+    // let the window fill with frames made at the new quality
+    if(governor->settle > 0) {
+        governor->settle--;
+        return;
+    }
+
+    uint32_t average = governor->window_sum / QUALITY_WINDOW;
+    if(average * 100 > governor->budget_us * QUALITY_OVERLOAD_PERCENT) {
+        governor->headroom = 0;
+        quality_governor_lower(governor);
+        governor->settle = QUALITY_SETTLE_FRAMES;
+    } else if(average * 100 < governor->budget_us * QUALITY_HEADROOM_PERCENT) {
+        // raise slowly, a knob that goes back up right away only makes the frame rate wobble
+        if(++governor->headroom >= QUALITY_HEADROOM_FRAMES) {
+            governor->headroom = 0;
+            quality_governor_raise(governor);
+            governor->settle = QUALITY_SETTLE_FRAMES;
+        }
+    } else {
+        governor->headroom = 0;
+    }
+}
+
+QualityState quality_governor_state_get(const QualityGovernor* governor) {
+    uint32_t average = governor->window_sum / QUALITY_WINDOW;
+    return (QualityState){
+        .budget_us = governor->budget_us,
+        .frame_us = average,
+        .steps_down = governor->steps_down,
+        .overloaded = average * 100 > governor->budget_us * QUALITY_OVERLOAD_PERCENT,
+    };
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Quality governor, keeps the frame time inside its budget by turning quality knobs down and up.
+ * Knobs are lowered one step at a time in the order they were added, and raised back in the
+ * reverse order once there is headroom again, so the first knob added is the first to give way.
+ */
+typedef struct QualityGovernor QualityGovernor;
+
+/** Knob handle */
+typedef uint8_t QualityKnob;
+
+#define QUALITY_KNOBS_MAX 8
+
+typedef struct {
+    uint32_t budget_us; // frame time budget
+    uint32_t frame_us; // recent average frame time
+    uint16_t steps_down; // knob steps currently taken below full quality
+    bool overloaded; // recent frames went over the budget
+} QualityState;
+
+/** Allocate a quality governor
+ * @param budget_us frame time budget in microseconds
+ * @return QualityGovernor*  QualityGovernor instance
+ */
+QualityGovernor* quality_governor_alloc(uint32_t budget_us);
+
+/** Free the quality governor
+ * @param governor QualityGovernor instance
+ */
+void quality_governor_free(QualityGovernor* governor);
+
+/** Add a knob, starting at full quality
+ * @param governor QualityGovernor instance
+ * @param name knob name, for logs, must stay valid
+ * @param full value at full quality
+ * @param lowest value at the lowest quality, can be above or below full
+ * @param step change per step, always positive
+ * @return QualityKnob  knob handle
+ */
+QualityKnob quality_governor_knob_add(
+    QualityGovernor* governor,
+    const char* name,
+    int32_t full,
+    int32_t lowest,
+    int32_t step);
+
+/** Get the current value of a knob
+ * @param governor QualityGovernor instance
+ * @param knob knob handle
+ * @return int32_t  value between full and lowest
+ */
+int32_t quality_governor_knob_get(const QualityGovernor* governor, QualityKnob knob);
+
+/** Report the time spent on a frame, may move one knob by one step
+ * @param governor QualityGovernor instance
+ * @param frame_us frame time in microseconds
+ */
+void quality_governor_frame(QualityGovernor* governor, uint32_t frame_us);
+
+/** Get the governor state
+ * @param governor QualityGovernor instance
+ * @return QualityState  state
+ */
+QualityState quality_governor_state_get(const QualityGovernor* governor);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+#include "rng.h"
+
+static uint32_t rng_splitmix32(uint32_t* state) {
+    uint32_t z = (*state += 0x9e3779b9);
+    z = (z ^ (z >> 16)) * 0x85ebca6b;
+    z = (z ^ (z >> 13)) * 0xc2b2ae35;
+    return z ^ (z >> 16);
+}
+
+void rng_seed(Rng* rng, uint32_t seed) {
+    // splitmix spreads the seed, so nearby seeds give unrelated streams
+    // and the state is never all zero
+    for(size_t i = 0; i < 4; i++) {
+        rng->s[i] = rng_splitmix32(&seed);
+    }
+}
+
+void rng_jump(Rng* rng) {
+    static const uint32_t jump[] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+
+    uint32_t s[4] = {0, 0, 0, 0};
+    for(size_t i = 0; i < 4; i++) {
+        for(int b = 0; b < 32; b++) {
+            if(jump[i] & (1u << b)) {
+                s[0] ^= rng->s[0];
+                s[1] ^= rng->s[1];
+                s[2] ^= rng->s[2];
+                s[3] ^= rng->s[3];
+            }
+            rng_next(rng);
+        }
+    }
+
+    for(size_t i = 0; i < 4; i++) {
+        rng->s[i] = s[i];
+    }
+}
+
+Rng rng_split(Rng* rng) {
+    Rng stream = *rng;
+    rng_jump(rng);
+    return stream;
+}
+
+void rng_fill(Rng* rng, uint32_t* out, size_t count) {
+    // work on a local copy so the state stays in registers
+    Rng local = *rng;
+    for(size_t i = 0; i < count; i++) {
+        out[i] = rng_next(&local);
+    }
+    *rng = local;
+}
+
+void rng_fill_float(Rng* rng, float* out, size_t count, float min, float max) {
+    Rng local = *rng;
+    float scale = (max - min) * (1.0f / 16777216.0f);
+    for(size_t i = 0; i < count; i++) {
+        out[i] = min + (float)(rng_next(&local) >> 8) * scale;
+    }
+    *rng = local;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * xoshiro128** random number generator.
+ * The whole state is this struct, so every level, entity or thread can own its
+ * stream and results are reproducible from the seed.
+ */
+typedef struct {
+    uint32_t s[4];
+} Rng;
+
+/** Seed the generator, any seed value (0 included) gives a valid state
+ * @param rng Rng instance
+ * @param seed seed value
+ */
+void rng_seed(Rng* rng, uint32_t seed);
+
+static inline uint32_t rng_rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+/** Next 32 random bits
+ * @param rng Rng instance
+ * @return uint32_t  random value
+ */
+static inline uint32_t rng_next(Rng* rng) {
+    uint32_t* s = rng->s;
+    uint32_t result = rng_rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rng_rotl(s[3], 11);
+
+    return result;
+}
+
+/** Random float in [0, 1)
+ * @param rng Rng instance
+ * @return float  random value
+ */
+static inline float rng_float(Rng* rng) {
+    // top 24 bits fill the float mantissa exactly
+    return (float)(rng_next(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+/** Random float in [min, max)
+ * @param rng Rng instance
+ * @param min lower bound
+ * @param max upper bound
+ * @return float  random value
+ */
+static inline float rng_range_float(Rng* rng, float min, float max) {
+    return min + rng_float(rng) * (max - min);
+}
+
+/** Random integer in [min, max], without modulo
+ * @param rng Rng instance
+ * @param min lower bound
+ * @param max upper bound, inclusive
+ * @return int32_t  random value
+ */
+static inline int32_t rng_range(Rng* rng, int32_t min, int32_t max) {
+    uint32_t span = (uint32_t)(max - min) + 1;
+    return min + (int32_t)(((uint64_t)rng_next(rng) * span) >> 32);
+}
+
+/** Advance the generator by 2^64 steps
+ * @param rng Rng instance
+ */
+void rng_jump(Rng* rng);
+
+/** Split off an independent stream
+ * The returned stream continues where the parent was, the parent jumps 2^64 steps ahead,
+ * so the two never overlap
+ * @param rng parent Rng instance
+ * @return Rng  new stream
+ */
+Rng rng_split(Rng* rng);
+
+/** Fill a buffer with random 32 bit values
+ * @param rng Rng instance
+ * @param out output buffer
+ * @param count number of values
+ */
+void rng_fill(Rng* rng, uint32_t* out, size_t count);
+
+/** Fill a buffer with random floats in [min, max)
+ * @param rng Rng instance
+ * @param out output buffer
+ * @param count number of values
+ * @param min lower bound
+ * @param max upper bound
+ */
+void rng_fill_float(Rng* rng, float* out, size_t count, float min, float max);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,15 +1,19 @@
+#ifndef ICM42688P_REPLAY // replaced by ICM42688P_replay.c
 #include "ICM42688P_regs.h"
 #include "ICM42688P.h"
 
 #define TAG "ICM42688P"
 
 #define ICM42688P_TIMEOUT 100
+#define ICM42688P_FIFO_WATERMARK_DEFAULT 1
+#define ICM42688P_FIFO_PACKET_EMPTY (1 << 7) // header of a packet read from an empty FIFO
 
 struct ICM42688P {
     FuriHalSpiBusHandle* spi_bus;
     const GpioPin* irq_pin;
     float accel_scale;
     float gyro_scale;
+    uint16_t fifo_watermark;
 };
 
 static const struct AccelFullScale {
@@ -62,7 +66,7 @@ static bool icm42688p_read_reg(FuriHalSpiBusHandle* spi_bus, uint8_t addr, uint8
 }
 
 static bool
-    icm42688p_read_mem(FuriHalSpiBusHandle* spi_bus, uint8_t addr, uint8_t* data, uint8_t len) {
+    icm42688p_read_mem(FuriHalSpiBusHandle* spi_bus, uint8_t addr, uint8_t* data, uint16_t len) {
     bool res = false;
     furi_hal_spi_acquire(spi_bus);
     do {
@@ -167,6 +171,19 @@ void icm42688p_apply_scale_fifo(
     gyro_data->z = ((float)(fifo_data->g_z)) / 32768.f * full_scale;
 }
 
+bool icm42688p_power_mode_set(ICM42688P* icm42688p, ICM42688PPowerMode mode) {
+    static const uint8_t modes[] = {
+        [PowerModeLowNoise] = ICM42688_PWR_GYRO_MODE_LN | ICM42688_PWR_ACCEL_MODE_LN,
+        [PowerModeLowPower] = ICM42688_PWR_GYRO_MODE_LN | ICM42688_PWR_ACCEL_MODE_LP,
+        [PowerModeAccelOnly] = ICM42688_PWR_GYRO_MODE_OFF | ICM42688_PWR_ACCEL_MODE_LP,
+    };
+    bool ret =
+        icm42688p_write_reg(icm42688p->spi_bus, ICM42688_PWR_MGMT0, ICM42688_PWR_TEMP_ON | modes[mode]);
+    // no register writes for 200 us after a power mode change
+    furi_delay_us(200);
+    return ret;
+}
+
 float icm42688p_read_temp(ICM42688P* icm42688p) {
     uint8_t reg_val[2];
 
@@ -175,22 +192,10 @@ float icm42688p_read_temp(ICM42688P* icm42688p) {
     return ((float)temp_int / 132.48f) + 25.f;
 }
 
-void icm42688_fifo_enable(
+static void icm42688p_irq_setup(
     ICM42688P* icm42688p,
     ICM42688PIrqCallback irq_callback,
     void* irq_context) {
-    // FIFO mode: stream
-    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_FIFO_CONFIG, (1 << 6));
-    // Little-endian data, FIFO count in records
-    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_INTF_CONFIG0, (1 << 7) | (1 << 6));
-    // FIFO partial read, FIFO packet: gyro + accel TODO: 20bit
-    icm42688p_write_reg(
-        icm42688p->spi_bus, ICM42688_FIFO_CONFIG1, (1 << 6) | (1 << 5) | (1 << 1) | (1 << 0));
-    // FIFO irq watermark
-    uint16_t fifo_watermark = 1;
-    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_FIFO_CONFIG2, fifo_watermark & 0xFF);
-    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_FIFO_CONFIG3, fifo_watermark >> 8);
-
     // IRQ1: push-pull, active high
     icm42688p_write_reg(icm42688p->spi_bus, ICM42688_INT_CONFIG, (1 << 1) | (1 << 0));
     // Clear IRQ on status read
@@ -200,18 +205,72 @@ void icm42688_fifo_enable(
 
     uint8_t reg_data = 0;
     icm42688p_read_reg(icm42688p->spi_bus, ICM42688_INT_STATUS, &reg_data);
+    icm42688p_read_reg(icm42688p->spi_bus, ICM42688_INT_STATUS2, &reg_data);
 
     furi_hal_gpio_init(icm42688p->irq_pin, GpioModeInterruptRise, GpioPullDown, GpioSpeedVeryHigh);
     furi_hal_gpio_remove_int_callback(icm42688p->irq_pin);
     furi_hal_gpio_add_int_callback(icm42688p->irq_pin, irq_callback, irq_context);
+}
+
+static void icm42688p_irq_release(ICM42688P* icm42688p) {
+    furi_hal_gpio_remove_int_callback(icm42688p->irq_pin);
+    furi_hal_gpio_init(icm42688p->irq_pin, GpioModeAnalog, GpioPullNo, GpioSpeedLow);
+}
+
+bool icm42688p_wom_enable(
+    ICM42688P* icm42688p,
+    uint8_t threshold,
+    ICM42688PIrqCallback irq_callback,
+    void* irq_context) {
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_REG_BANK_SEL, 4);
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_ACCEL_WOM_X_THR, threshold);
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_ACCEL_WOM_Y_THR, threshold);
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_ACCEL_WOM_Z_THR, threshold);
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_REG_BANK_SEL, 0);
+
+    icm42688p_irq_setup(icm42688p, irq_callback, irq_context);
+
+    // IRQ1 source: WOM on any axis
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_INT_SOURCE1, (1 << 2) | (1 << 1) | (1 << 0));
+    // WOM: any axis, compared to the previous sample, SMD mode WOM
+    return icm42688p_write_reg(icm42688p->spi_bus, ICM42688_SMD_CONFIG, (1 << 2) | (1 << 0));
+}
+
+void icm42688p_wom_disable(ICM42688P* icm42688p) {
+    icm42688p_irq_release(icm42688p);
+
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_SMD_CONFIG, 0);
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_INT_SOURCE1, 0);
+}
+
+bool icm42688p_wom_triggered(ICM42688P* icm42688p) {
+    uint8_t reg_data = 0;
+    icm42688p_read_reg(icm42688p->spi_bus, ICM42688_INT_STATUS2, &reg_data);
+    return reg_data & ((1 << 2) | (1 << 1) | (1 << 0));
+}
+
+void icm42688_fifo_enable(
+    ICM42688P* icm42688p,
+    ICM42688PIrqCallback irq_callback,
+    void* irq_context) {
+    // FIFO mode: stream
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_FIFO_CONFIG, (1 << 6));
+    // Little-endian data, FIFO count in records
+    icm42688p_write_reg(icm42688p->spi_bus, ICM42688_INTF_CONFIG0, (1 << 7) | (1 << 6));
+    // FIFO partial read, FIFO packet: gyro + accel TODO: 20bit
+    icm42688p_write_reg(
+        icm42688p->spi_bus, ICM42688_FIFO_CONFIG1, (1 << 6) | (1 << 5) | (1 << 1) | (1 << 0));
+    // FIFO irq watermark
+    icm42688_fifo_watermark_set(icm42688p, icm42688p->fifo_watermark);
+
+    icm42688p_irq_setup(icm42688p, irq_callback, irq_context);
 
     // IRQ1 source: FIFO threshold
     icm42688p_write_reg(icm42688p->spi_bus, ICM42688_INT_SOURCE0, (1 << 2));
 }
 
 void icm42688_fifo_disable(ICM42688P* icm42688p) {
-    furi_hal_gpio_remove_int_callback(icm42688p->irq_pin);
-    furi_hal_gpio_init(icm42688p->irq_pin, GpioModeAnalog, GpioPullNo, GpioSpeedLow);
+    icm42688p_irq_release(icm42688p);
 
     icm42688p_write_reg(icm42688p->spi_bus, ICM42688_INT_SOURCE0, 0);
 
@@ -225,16 +284,51 @@ uint16_t icm42688_fifo_get_count(ICM42688P* icm42688p) {
     return reg_val;
 }
 
+bool icm42688_fifo_watermark_set(ICM42688P* icm42688p, uint16_t packets) {
+    // FIFO count is in records, so the watermark is too
+    furi_check(packets > 0 && packets <= ICM42688P_FIFO_WATERMARK_MAX);
+    icm42688p->fifo_watermark = packets;
+
+    bool ret = icm42688p_write_reg(icm42688p->spi_bus, ICM42688_FIFO_CONFIG2, packets & 0xFF);
+    ret &= icm42688p_write_reg(icm42688p->spi_bus, ICM42688_FIFO_CONFIG3, packets >> 8);
+    return ret;
+}
+
+uint16_t icm42688_fifo_watermark_get(ICM42688P* icm42688p) {
+    return icm42688p->fifo_watermark;
+}
+
 bool icm42688_fifo_read(ICM42688P* icm42688p, ICM42688PFifoPacket* data) {
     icm42688p_read_mem(
         icm42688p->spi_bus, ICM42688_FIFO_DATA, (uint8_t*)data, sizeof(ICM42688PFifoPacket));
-    return (data->header) & (1 << 7);
+    return (data->header) & ICM42688P_FIFO_PACKET_EMPTY;
+}
+
+uint16_t icm42688_fifo_read_burst(ICM42688P* icm42688p, ICM42688PFifoPacket* data, uint16_t count) {
+    // FIFO data comes out packet after packet while the address stays on FIFO_DATA,
+    // so the whole batch is a single transaction
+    if(count == 0 ||
+       !icm42688p_read_mem(
+           icm42688p->spi_bus,
+           ICM42688_FIFO_DATA,
+           (uint8_t*)data,
+           count * sizeof(ICM42688PFifoPacket))) {
+        return 0;
+    }
+
+    // packets past the end of the FIFO come back marked as empty
+    uint16_t read = 0;
+    while(read < count && !(data[read].header & ICM42688P_FIFO_PACKET_EMPTY)) {
+        read++;
+    }
+    return read;
 }
 
 ICM42688P* icm42688p_alloc(FuriHalSpiBusHandle* spi_bus, const GpioPin* irq_pin) {
     ICM42688P* icm42688p = malloc(sizeof(ICM42688P));
     icm42688p->spi_bus = spi_bus;
     icm42688p->irq_pin = irq_pin;
+    icm42688p->fifo_watermark = ICM42688P_FIFO_WATERMARK_DEFAULT;
     return icm42688p;
 }
 
@@ -295,3 +389,5 @@ bool icm42688p_deinit(ICM42688P* icm42688p) {
     furi_hal_spi_bus_handle_deinit(icm42688p->spi_bus);
     return true;
 }
+
+#endif
@@ -45,6 +45,12 @@ typedef enum {
     GyroFullScaleTotal,
 } ICM42688PGyroFullScale;
 
+typedef enum {
+    PowerModeLowNoise = 0, // gyro and accel low noise
+    PowerModeLowPower, // gyro low noise, accel low power
+    PowerModeAccelOnly, // gyro off, accel low power, for wake-on-motion
+} ICM42688PPowerMode;
+
 typedef struct {
     int16_t x;
     int16_t y;
@@ -69,6 +75,8 @@ typedef struct {
     float z;
 } ICM42688PScaledData;
 
+#define ICM42688P_FIFO_WATERMARK_MAX 128 // 2 KiB FIFO / 16 byte packets
+
 typedef struct ICM42688P ICM42688P;
 
 typedef void (*ICM42688PIrqCallback)(void* ctx);
@@ -111,6 +119,21 @@ void icm42688p_apply_scale_fifo(
 
 float icm42688p_read_temp(ICM42688P* icm42688p);
 
+// Gyro needs 45 ms after being switched on before its data is valid
+bool icm42688p_power_mode_set(ICM42688P* icm42688p, ICM42688PPowerMode mode);
+
+// IRQ on an accel change over threshold between samples, 1 LSB = 1/256 g, needs accel running
+bool icm42688p_wom_enable(
+    ICM42688P* icm42688p,
+    uint8_t threshold,
+    ICM42688PIrqCallback irq_callback,
+    void* irq_context);
+
+void icm42688p_wom_disable(ICM42688P* icm42688p);
+
+// Reads and clears the WOM status
+bool icm42688p_wom_triggered(ICM42688P* icm42688p);
+
 void icm42688_fifo_enable(
     ICM42688P* icm42688p,
     ICM42688PIrqCallback irq_callback,
@@ -122,6 +145,24 @@ uint16_t icm42688_fifo_get_count(ICM42688P* icm42688p);
 
 bool icm42688_fifo_read(ICM42688P* icm42688p, ICM42688PFifoPacket* data);
 
+// Reads up to count packets in one transaction, returns how many of them are valid
+uint16_t icm42688_fifo_read_burst(ICM42688P* icm42688p, ICM42688PFifoPacket* data, uint16_t count);
+
+// Watermark in packets, the IRQ fires once the FIFO holds that many
+bool icm42688_fifo_watermark_set(ICM42688P* icm42688p, uint16_t packets);
+
+uint16_t icm42688_fifo_watermark_get(ICM42688P* icm42688p);
+
+#ifdef ICM42688P_REPLAY
+// Host stand-in serving recorded packets, see ICM42688P_replay.c
+bool icm42688p_replay_load(ICM42688P* icm42688p, const char* path);
+
+// 1 for real time, 0 to serve packets as fast as they are read
+void icm42688p_replay_speed_set(ICM42688P* icm42688p, float speed);
+
+bool icm42688p_replay_done(ICM42688P* icm42688p);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
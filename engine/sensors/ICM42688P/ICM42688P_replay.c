@@ -0,0 +1,381 @@
+/* Stand-in for the ICM42688P driver that serves recorded FIFO packets, for host builds.
+ * Build with ICM42688P_REPLAY instead of ICM42688P.c. Recordings are raw FIFO packets back to back,
+ * as written by imu_record_start(). Packets are released into a simulated FIFO at the pace of their
+ * timestamps, and the IRQ callback fires when the FIFO reaches the watermark, like the real chip. */
+#ifdef ICM42688P_REPLAY
+#include "ICM42688P.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define TAG "ICM42688P"
+
+#define ICM42688P_FIFO_PACKETS 128 // 2 KiB FIFO / 16 byte packets
+#define ICM42688P_FIFO_PACKET_EMPTY (1 << 7)
+
+#define ICM42688P_REPLAY_FILE_ENV "ICM42688P_REPLAY_FILE"
+#define ICM42688P_REPLAY_SPEED_ENV "ICM42688P_REPLAY_SPEED"
+
+struct ICM42688P {
+    float accel_scale;
+    float gyro_scale;
+    uint16_t fifo_watermark;
+
+    ICM42688PFifoPacket* packets;
+    size_t packets_count;
+    float speed; // 1 real time, 0 as fast as the reader drains the FIFO
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t drained;
+    bool thread_running;
+    bool stop;
+
+    // guarded by mutex
+    size_t released; // packets pushed into the FIFO so far
+    size_t read_index; // next packet to read
+    ICM42688PIrqCallback irq_callback;
+    void* irq_context;
+};
+
+static size_t icm42688p_replay_available(ICM42688P* icm42688p) {
+    return icm42688p->released - icm42688p->read_index;
+}
+
+static uint64_t icm42688p_replay_now_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+static void* icm42688p_replay_thread(void* context) {
+    ICM42688P* icm42688p = context;
+    uint64_t start_us = icm42688p_replay_now_us();
+    uint64_t packet_us = 0;
+
+    // the recording carries on where the last enable left it
+    pthread_mutex_lock(&icm42688p->mutex);
+    size_t first = icm42688p->released;
+    pthread_mutex_unlock(&icm42688p->mutex);
+
+    size_t i = first;
+    for(; i < icm42688p->packets_count; i++) {
+        // 16 bit FIFO timestamps wrap every 65 ms, unwrap them into a running time
+        if(i > first) {
+            packet_us += (uint16_t)(icm42688p->packets[i].ts - icm42688p->packets[i - 1].ts);
+        }
+
+        if(icm42688p->speed > 0.f) {
+            uint64_t due_us = start_us + (uint64_t)((float)packet_us / icm42688p->speed);
+            uint64_t now_us = icm42688p_replay_now_us();
+            if(due_us > now_us) {
+                struct timespec wait = {
+                    .tv_sec = (due_us - now_us) / 1000000,
+                    .tv_nsec = ((due_us - now_us) % 1000000) * 1000,
+                };
+                nanosleep(&wait, NULL);
+            }
+        }
+
+        pthread_mutex_lock(&icm42688p->mutex);
+        if(icm42688p->speed <= 0.f) {
+            // as fast as possible, but never faster than the reader, nothing is dropped
+            while(!icm42688p->stop &&
+                  icm42688p_replay_available(icm42688p) >= icm42688p->fifo_watermark) {
+                pthread_cond_wait(&icm42688p->drained, &icm42688p->mutex);
+            }
+        }
+        if(icm42688p->stop) {
+            pthread_mutex_unlock(&icm42688p->mutex);
+            break;
+        }
+
+        icm42688p->released = i + 1;
+        if(icm42688p_replay_available(icm42688p) > ICM42688P_FIFO_PACKETS) {
+            // stream mode: a full FIFO drops its oldest packet
+            icm42688p->read_index++;
+        }
+
+        // threshold IRQ fires when the count reaches the watermark
+        ICM42688PIrqCallback callback = NULL;
+        void* callback_context = NULL;
+        if(icm42688p_replay_available(icm42688p) == icm42688p->fifo_watermark) {
+            callback = icm42688p->irq_callback;
+            callback_context = icm42688p->irq_context;
+        }
+        pthread_mutex_unlock(&icm42688p->mutex);
+
+        if(callback) {
+            callback(callback_context);
+        }
+    }
+
+    // a FIFO disable stops the thread early, the recording carries on with the next enable
+    if(i == icm42688p->packets_count) {
+        pthread_mutex_lock(&icm42688p->mutex);
+        size_t released = icm42688p->released;
+        pthread_mutex_unlock(&icm42688p->mutex);
+        FURI_LOG_I(TAG, "Replay finished, %zu packets released", released);
+    }
+    return NULL;
+}
+
+bool icm42688p_replay_load(ICM42688P* icm42688p, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        FURI_LOG_E(TAG, "Cannot open replay %s", path);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    free(icm42688p->packets);
+    icm42688p->packets_count = size > 0 ? (size_t)size / sizeof(ICM42688PFifoPacket) : 0;
+    icm42688p->packets = malloc(icm42688p->packets_count * sizeof(ICM42688PFifoPacket) + 1);
+    icm42688p->packets_count = fread(
+        icm42688p->packets, sizeof(ICM42688PFifoPacket), icm42688p->packets_count, file);
+    fclose(file);
+
+    FURI_LOG_I(TAG, "Loaded %zu packets from %s", icm42688p->packets_count, path);
+    return icm42688p->packets_count > 0;
+}
+
+void icm42688p_replay_speed_set(ICM42688P* icm42688p, float speed) {
+    icm42688p->speed = speed;
+}
+
+bool icm42688p_replay_done(ICM42688P* icm42688p) {
+    pthread_mutex_lock(&icm42688p->mutex);
+    bool done = icm42688p->released == icm42688p->packets_count &&
+                icm42688p_replay_available(icm42688p) == 0;
+    pthread_mutex_unlock(&icm42688p->mutex);
+    return done;
+}
+
+ICM42688P* icm42688p_alloc(FuriHalSpiBusHandle* spi_bus, const GpioPin* irq_pin) {
+    UNUSED(spi_bus);
+    UNUSED(irq_pin);
+    ICM42688P* icm42688p = malloc(sizeof(ICM42688P));
+    memset(icm42688p, 0, sizeof(ICM42688P));
+    icm42688p->fifo_watermark = 1;
+    icm42688p->speed = 1.f;
+    pthread_mutex_init(&icm42688p->mutex, NULL);
+    pthread_cond_init(&icm42688p->drained, NULL);
+    return icm42688p;
+}
+
+void icm42688p_free(ICM42688P* icm42688p) {
+    icm42688_fifo_disable(icm42688p);
+    pthread_cond_destroy(&icm42688p->drained);
+    pthread_mutex_destroy(&icm42688p->mutex);
+    free(icm42688p->packets);
+    free(icm42688p);
+}
+
+bool icm42688p_init(ICM42688P* icm42688p) {
+    // the IMU code allocates the driver itself, so the recording comes from the environment
+    const char* speed = getenv(ICM42688P_REPLAY_SPEED_ENV);
+    if(speed) {
+        icm42688p->speed = strtof(speed, NULL);
+    }
+    if(!icm42688p->packets) {
+        const char* path = getenv(ICM42688P_REPLAY_FILE_ENV);
+        if(!path || !icm42688p_replay_load(icm42688p, path)) {
+            FURI_LOG_E(TAG, "No replay, set %s", ICM42688P_REPLAY_FILE_ENV);
+            return false;
+        }
+    }
+
+    icm42688p_accel_config(icm42688p, AccelFullScale16G, DataRate1kHz);
+    icm42688p_gyro_config(icm42688p, GyroFullScale2000DPS, DataRate1kHz);
+    return true;
+}
+
+bool icm42688p_deinit(ICM42688P* icm42688p) {
+    UNUSED(icm42688p);
+    return true;
+}
+
+bool icm42688p_accel_config(
+    ICM42688P* icm42688p,
+    ICM42688PAccelFullScale full_scale,
+    ICM42688PDataRate rate) {
+    UNUSED(rate);
+    icm42688p->accel_scale = (float)(16 >> full_scale);
+    return true;
+}
+
+float icm42688p_accel_get_full_scale(ICM42688P* icm42688p) {
+    return icm42688p->accel_scale;
+}
+
+bool icm42688p_gyro_config(
+    ICM42688P* icm42688p,
+    ICM42688PGyroFullScale full_scale,
+    ICM42688PDataRate rate) {
+    UNUSED(rate);
+    icm42688p->gyro_scale = 2000.f / (float)(1 << full_scale);
+    return true;
+}
+
+float icm42688p_gyro_get_full_scale(ICM42688P* icm42688p) {
+    return icm42688p->gyro_scale;
+}
+
+static const ICM42688PFifoPacket* icm42688p_replay_current(ICM42688P* icm42688p) {
+    // direct register reads see the newest sample, before streaming starts that is the first one
+    size_t index = icm42688p->released > 0 ? icm42688p->released - 1 : 0;
+    return &icm42688p->packets[index];
+}
+
+bool icm42688p_read_accel_raw(ICM42688P* icm42688p, ICM42688PRawData* data) {
+    pthread_mutex_lock(&icm42688p->mutex);
+    const ICM42688PFifoPacket* packet = icm42688p_replay_current(icm42688p);
+    *data = (ICM42688PRawData){.x = packet->a_x, .y = packet->a_y, .z = packet->a_z};
+    pthread_mutex_unlock(&icm42688p->mutex);
+    return true;
+}
+
+bool icm42688p_read_gyro_raw(ICM42688P* icm42688p, ICM42688PRawData* data) {
+    pthread_mutex_lock(&icm42688p->mutex);
+    const ICM42688PFifoPacket* packet = icm42688p_replay_current(icm42688p);
+    *data = (ICM42688PRawData){.x = packet->g_x, .y = packet->g_y, .z = packet->g_z};
+    pthread_mutex_unlock(&icm42688p->mutex);
+    return true;
+}
+
+bool icm42688p_write_gyro_offset(ICM42688P* icm42688p, ICM42688PScaledData* scaled_data) {
+    // recorded packets already carry the offsets of the recording device
+    UNUSED(icm42688p);
+    UNUSED(scaled_data);
+    return true;
+}
+
+void icm42688p_apply_scale(ICM42688PRawData* raw_data, float full_scale, ICM42688PScaledData* data) {
+    data->x = ((float)(raw_data->x)) / 32768.f * full_scale;
+    data->y = ((float)(raw_data->y)) / 32768.f * full_scale;
+    data->z = ((float)(raw_data->z)) / 32768.f * full_scale;
+}
+
+void icm42688p_apply_scale_fifo(
+    ICM42688P* icm42688p,
+    ICM42688PFifoPacket* fifo_data,
+    ICM42688PScaledData* accel_data,
+    ICM42688PScaledData* gyro_data) {
+    float full_scale = icm42688p->accel_scale;
+    accel_data->x = ((float)(fifo_data->a_x)) / 32768.f * full_scale;
+    accel_data->y = ((float)(fifo_data->a_y)) / 32768.f * full_scale;
+    accel_data->z = ((float)(fifo_data->a_z)) / 32768.f * full_scale;
+
+    full_scale = icm42688p->gyro_scale;
+    gyro_data->x = ((float)(fifo_data->g_x)) / 32768.f * full_scale;
+    gyro_data->y = ((float)(fifo_data->g_y)) / 32768.f * full_scale;
+    gyro_data->z = ((float)(fifo_data->g_z)) / 32768.f * full_scale;
+}
+
+float icm42688p_read_temp(ICM42688P* icm42688p) {
+    UNUSED(icm42688p);
+    return 25.f;
+}
+
+bool icm42688p_power_mode_set(ICM42688P* icm42688p, ICM42688PPowerMode mode) {
+    UNUSED(icm42688p);
+    UNUSED(mode);
+    return true;
+}
+
+bool icm42688p_wom_enable(
+    ICM42688P* icm42688p,
+    uint8_t threshold,
+    ICM42688PIrqCallback irq_callback,
+    void* irq_context) {
+    // a recording has no idle gaps to wake from, callers keep streaming
+    UNUSED(icm42688p);
+    UNUSED(threshold);
+    UNUSED(irq_callback);
+    UNUSED(irq_context);
+    return false;
+}
+
+void icm42688p_wom_disable(ICM42688P* icm42688p) {
+    UNUSED(icm42688p);
+}
+
+bool icm42688p_wom_triggered(ICM42688P* icm42688p) {
+    UNUSED(icm42688p);
+    return false;
+}
+
+void icm42688_fifo_enable(
+    ICM42688P* icm42688p,
+    ICM42688PIrqCallback irq_callback,
+    void* irq_context) {
+    icm42688_fifo_disable(icm42688p);
+
+    pthread_mutex_lock(&icm42688p->mutex);
+    icm42688p->irq_callback = irq_callback;
+    icm42688p->irq_context = irq_context;
+    icm42688p->stop = false;
+    pthread_mutex_unlock(&icm42688p->mutex);
+
+    icm42688p->thread_running =
+        pthread_create(&icm42688p->thread, NULL, icm42688p_replay_thread, icm42688p) == 0;
+}
+
+void icm42688_fifo_disable(ICM42688P* icm42688p) {
+    if(!icm42688p->thread_running) return;
+
+    pthread_mutex_lock(&icm42688p->mutex);
+    icm42688p->stop = true;
+    icm42688p->irq_callback = NULL;
+    // bypass mode flushes the FIFO
+    icm42688p->read_index = icm42688p->released;
+    pthread_cond_broadcast(&icm42688p->drained);
+    pthread_mutex_unlock(&icm42688p->mutex);
+
+    pthread_join(icm42688p->thread, NULL);
+    icm42688p->thread_running = false;
+}
+
+uint16_t icm42688_fifo_get_count(ICM42688P* icm42688p) {
+    pthread_mutex_lock(&icm42688p->mutex);
+    uint16_t count = icm42688p_replay_available(icm42688p);
+    pthread_mutex_unlock(&icm42688p->mutex);
+    return count;
+}
+
+bool icm42688_fifo_read(ICM42688P* icm42688p, ICM42688PFifoPacket* data) {
+    return icm42688_fifo_read_burst(icm42688p, data, 1) == 0;
+}
+
+uint16_t icm42688_fifo_read_burst(ICM42688P* icm42688p, ICM42688PFifoPacket* data, uint16_t count) {
+    pthread_mutex_lock(&icm42688p->mutex);
+    uint16_t read = MIN(count, icm42688p_replay_available(icm42688p));
+    memcpy(data, &icm42688p->packets[icm42688p->read_index], read * sizeof(ICM42688PFifoPacket));
+    icm42688p->read_index += read;
+    pthread_cond_broadcast(&icm42688p->drained);
+    pthread_mutex_unlock(&icm42688p->mutex);
+
+    // reading past the end of the FIFO gives packets marked as empty
+    for(uint16_t i = read; i < count; i++) {
+        memset(&data[i], 0, sizeof(ICM42688PFifoPacket));
+        data[i].header = ICM42688P_FIFO_PACKET_EMPTY;
+    }
+    return read;
+}
+
+bool icm42688_fifo_watermark_set(ICM42688P* icm42688p, uint16_t packets) {
+    furi_check(packets > 0 && packets <= ICM42688P_FIFO_WATERMARK_MAX);
+    pthread_mutex_lock(&icm42688p->mutex);
+    icm42688p->fifo_watermark = packets;
+    pthread_mutex_unlock(&icm42688p->mutex);
+    return true;
+}
+
+uint16_t icm42688_fifo_watermark_get(ICM42688P* icm42688p) {
+    return icm42688p->fifo_watermark;
+}
+
+#endif
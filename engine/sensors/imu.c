@@ -1,12 +1,17 @@
 #include <furi.h>
+#include <stdatomic.h>
+#include <storage/storage.h>
 #include "imu.h"
 #include "ICM42688P/ICM42688P.h"
 
 #define TAG "IMU"
 
-#define ACCEL_GYRO_RATE DataRate100Hz
+#define IMU_RATE_DEFAULT 100 // Hz
+#define IMU_LOW_POWER_RATE_MAX 500 // accel low power mode stops here
 
-#define FILTER_SAMPLE_FREQ 100.f
+#define FILTER_DT_MIN 0.25f // sample intervals outside these, in periods, are glitches
+#define FILTER_DT_MAX 4.f
+#define FIFO_TIMESTAMP_S 0.000001f // FIFO timestamp resolution, 1 us
 #define FILTER_BETA 0.08f
 
 #define SAMPLE_RATE_DIV 5
@@ -14,103 +19,461 @@
 #define SENSITIVITY_K 30.f
 #define EXP_RATE 1.1f
 
-#define IMU_CALI_AVG 64
+#define IMU_CALI_SAMPLES 64 // FIFO packets per calibration
+#define IMU_CALI_RATE DataRate1kHz // fast ODR for the startup calibration
+#define IMU_CALI_TIMEOUT_MS 200
+#define IMU_CALI_MOTION_DPS 3.f // spread of still samples must stay under this
+#define IMU_CALI_OUTLIER_MAD 3 // samples further than this many MADs from the median are dropped
+#define IMU_CALI_TEMP_DELTA 8.f // cached offsets are trusted within this many degrees
+#define IMU_CALI_MAGIC 0x31435947 // "GYC1"
+#define IMU_CALI_PATH APP_DATA_PATH("imu_gyro.cal")
+
+#define IMU_FIFO_LATENCY_MS 40 // default, watermark follows the rate, wakeups stay at 25 per second
+#define IMU_FIFO_BURST 8 // packets per SPI transaction
+#define IMU_PREDICT_MAX_LATENCIES 3 // older samples mean the stream stopped, they are not extrapolated
+
+#define IMU_IDLE_AFTER_MS 2000 // no rotation for this long puts the sensor to sleep
+#define IMU_IDLE_GYRO_RAD (4.f * (float)M_PI / 180.f) // rotation below 4 dps counts as still
+#define IMU_IDLE_RATE DataRate25Hz // accel rate watched by wake-on-motion
+#define IMU_WOM_THRESHOLD 13 // ~50 mg between samples
+
+#define IMU_RECORD_BUFFER 32 // packets per SD write, 512 bytes
+
+#define IMU_SAMPLES_SIZE 64 // sample ring, power of two, 320 ms at 200 Hz
 
 typedef enum {
     ImuStop = (1 << 0),
     ImuNewData = (1 << 1),
+    ImuRecord = (1 << 2),
+    ImuConfig = (1 << 3),
 } ImuThreadFlags;
 
-#define FLAGS_ALL (ImuStop | ImuNewData)
+#define FLAGS_ALL (ImuStop | ImuNewData | ImuRecord | ImuConfig)
+
+static const struct ImuRate {
+    uint16_t hz;
+    ICM42688PDataRate rate;
+} imu_rates[] = {
+    {25, DataRate25Hz},
+    {50, DataRate50Hz},
+    {100, DataRate100Hz},
+    {200, DataRate200Hz},
+    {500, DataRate500Hz},
+    {1000, DataRate1kHz},
+};
 
 typedef struct {
     float q0;
     float q1;
     float q2;
     float q3;
-    float roll;
-    float pitch;
-    float yaw;
+    float gx;
+    float gy;
+    float gz;
+    uint32_t generation;
+    uint16_t timestamp; // FIFO timestamp of the last sample
+    bool timestamp_valid;
 } ImuProcessedData;
 
+/* Single producer, single consumer sample ring: the sensor thread only moves tail,
+ * the reader only moves head. A full ring drops new samples, the oldest stay. */
+typedef struct {
+    ImuSample items[IMU_SAMPLES_SIZE];
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    _Atomic uint32_t dropped;
+    _Atomic bool enabled;
+} ImuSampleRing;
+
+#define IMU_ORIENTATION_WORDS (sizeof(ImuOrientation) / sizeof(uint32_t))
+
+static_assert(sizeof(ImuOrientation) % sizeof(uint32_t) == 0, "ImuOrientation must be whole words");
+
+/* Seqlock: the sequence is odd while the sensor thread writes, readers retry if it was odd
+ * or changed while they copied. Words are atomics so a torn copy is only ever discarded. */
+typedef struct {
+    _Atomic uint32_t sequence;
+    _Atomic uint32_t words[IMU_ORIENTATION_WORDS];
+} ImuSeqlock;
+
+typedef struct {
+    uint32_t magic;
+    float x; // gyro offsets in dps
+    float y;
+    float z;
+    float temperature; // sensor temperature when measured
+} ImuGyroCalibration;
+
 typedef struct {
     FuriThread* thread;
     ICM42688P* icm42688p;
     ImuProcessedData processed_data;
+    float gyro_rad_scale; // raw gyro to rad/s
+    float accel_g_scale; // raw accel to g
+    float sample_dt; // nominal sample interval
+
+    // configuration requested by the game, applied by the thread on ImuConfig
+    _Atomic uint16_t rate_request;
+    _Atomic uint8_t power_request;
+    _Atomic uint16_t latency_request;
+    _Atomic uint32_t irq_tick; // when the FIFO IRQ fired, the newest sample of the batch landed then
+    _Atomic bool auto_idle_request;
+    _Atomic bool idle_state;
+
+    // configuration in use
+    const struct ImuRate* rate;
+    ImuPowerMode power;
+    uint16_t latency_ms;
+    bool auto_idle;
+    bool idle;
+    bool wom_unsupported;
+    bool moved;
+    uint32_t still_since;
+    ImuSeqlock published;
+    ImuSampleRing samples;
     bool lefty;
+
+    // gyro calibration, refined from the first still samples of the stream when loaded from SD
+    ImuGyroCalibration calibration;
+    ICM42688PFifoPacket cali_packets[IMU_CALI_SAMPLES];
+    uint16_t cali_count;
+    bool cali_refine;
+    // SD access stays on the caller's thread: imu_start reads the cache, imu_stop saves it
+    ImuGyroCalibration cali_cached;
+    bool cali_cached_valid;
+    bool cali_dirty;
+
+    // raw packet recorder, files are opened by the caller and handed over through record_next
+    File* _Atomic record_next;
+    File* record_file;
+    ICM42688PFifoPacket record_buffer[IMU_RECORD_BUFFER];
+    uint16_t record_count;
 } ImuThread;
 
+static void imu_seqlock_write(ImuSeqlock* lock, const ImuOrientation* orientation) {
+    uint32_t words[IMU_ORIENTATION_WORDS];
+    memcpy(words, orientation, sizeof(words));
+
+    uint32_t sequence = atomic_load_explicit(&lock->sequence, memory_order_relaxed);
+    atomic_store_explicit(&lock->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for(size_t i = 0; i < IMU_ORIENTATION_WORDS; i++) {
+        atomic_store_explicit(&lock->words[i], words[i], memory_order_relaxed);
+    }
+    atomic_store_explicit(&lock->sequence, sequence + 2, memory_order_release);
+}
+
+static void imu_seqlock_read(ImuSeqlock* lock, ImuOrientation* orientation) {
+    uint32_t words[IMU_ORIENTATION_WORDS];
+    uint32_t before;
+    uint32_t after;
+
+    do {
+        before = atomic_load_explicit(&lock->sequence, memory_order_acquire);
+        for(size_t i = 0; i < IMU_ORIENTATION_WORDS; i++) {
+            words[i] = atomic_load_explicit(&lock->words[i], memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&lock->sequence, memory_order_relaxed);
+    } while((before & 1) || before != after);
+
+    memcpy(orientation, words, sizeof(words));
+}
+
 static void imu_madgwick_filter(
     ImuProcessedData* out,
     ICM42688PScaledData* accel,
-    ICM42688PScaledData* gyro);
+    ICM42688PScaledData* gyro,
+    float dt);
+
+static void imu_sample_push(ImuSampleRing* ring, const ImuSample* sample) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if(tail - head == IMU_SAMPLES_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    ring->items[tail % IMU_SAMPLES_SIZE] = *sample;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
 
 static void imu_irq_callback(void* context) {
     furi_assert(context);
     ImuThread* imu = context;
+    atomic_store_explicit(&imu->irq_tick, furi_get_tick(), memory_order_relaxed);
     furi_thread_flags_set(furi_thread_get_id(imu->thread), ImuNewData);
 }
 
 static void imu_process_data(ImuThread* imu, ICM42688PFifoPacket* in_data) {
-    ICM42688PScaledData accel_data;
-    ICM42688PScaledData gyro_data;
+    ImuProcessedData* out = &imu->processed_data;
 
-    // Get accel and gyro data in g and degrees/s
-    icm42688p_apply_scale_fifo(imu->icm42688p, in_data, &accel_data, &gyro_data);
+    // Accel is only used as a direction, normalised by the filter, so it needs no scaling
+    ICM42688PScaledData accel_data = {
+        .x = (float)in_data->a_x,
+        .y = (float)in_data->a_y,
+        .z = (float)in_data->a_z,
+    };
+
+    // Gyro: raw to rads/s in a single multiply
+    ICM42688PScaledData gyro_data = {
+        .x = (float)in_data->g_x * imu->gyro_rad_scale,
+        .y = (float)in_data->g_y * imu->gyro_rad_scale,
+        .z = (float)in_data->g_z * imu->gyro_rad_scale,
+    };
+
+    // Rotation keeps the sensor awake
+    if(gyro_data.x * gyro_data.x + gyro_data.y * gyro_data.y + gyro_data.z * gyro_data.z >
+       IMU_IDLE_GYRO_RAD * IMU_IDLE_GYRO_RAD) {
+        imu->moved = true;
+    }
 
-    // Gyro: degrees/s to rads/s
-    gyro_data.x = gyro_data.x / 180.f * M_PI;
-    gyro_data.y = gyro_data.y / 180.f * M_PI;
-    gyro_data.z = gyro_data.z / 180.f * M_PI;
+    // Real sample interval from the FIFO timestamps, 16 bit counter wraps every 65 ms
+    float dt = imu->sample_dt;
+    if(out->timestamp_valid) {
+        float interval = (uint16_t)(in_data->ts - out->timestamp) * FIFO_TIMESTAMP_S;
+        if(interval >= FILTER_DT_MIN * imu->sample_dt && interval <= FILTER_DT_MAX * imu->sample_dt) {
+            dt = interval;
+        }
+    }
+    out->timestamp = in_data->ts;
+    out->timestamp_valid = true;
+
+    // Sensor Fusion algorithm, on a copy since the filter normalises accel in place
+    ICM42688PScaledData accel_direction = accel_data;
+    imu_madgwick_filter(out, &accel_direction, &gyro_data, dt);
+    out->gx = gyro_data.x;
+    out->gy = gyro_data.y;
+    out->gz = gyro_data.z;
+
+    if(atomic_load_explicit(&imu->samples.enabled, memory_order_relaxed)) {
+        ImuSample sample = {
+            .ax = accel_data.x * imu->accel_g_scale,
+            .ay = accel_data.y * imu->accel_g_scale,
+            .az = accel_data.z * imu->accel_g_scale,
+            .gx = gyro_data.x,
+            .gy = gyro_data.y,
+            .gz = gyro_data.z,
+            .q0 = out->q0,
+            .q1 = out->q1,
+            .q2 = out->q2,
+            .q3 = out->q3,
+            .dt = dt,
+        };
+        imu_sample_push(&imu->samples, &sample);
+    }
+}
 
-    // Sensor Fusion algorithm
-    ImuProcessedData* out = &imu->processed_data;
-    imu_madgwick_filter(out, &accel_data, &gyro_data);
+static void imu_publish(ImuThread* imu, uint32_t sample_tick) {
+    // Only the quaternion is published, readers convert to Euler angles when they need them
+    ImuProcessedData* data = &imu->processed_data;
+    ImuOrientation orientation = {
+        .q0 = data->q0,
+        .q1 = data->q1,
+        .q2 = data->q2,
+        .q3 = data->q3,
+        .gx = data->gx,
+        .gy = data->gy,
+        .gz = data->gz,
+        .timestamp = sample_tick,
+        .generation = ++data->generation,
+    };
+    imu_seqlock_write(&imu->published, &orientation);
+}
 
-    // Quaternion to euler angles
-    float roll = atan2f(
-        out->q0 * out->q1 + out->q2 * out->q3, 0.5f - out->q1 * out->q1 - out->q2 * out->q2);
-    float pitch = asinf(-2.0f * (out->q1 * out->q3 - out->q0 * out->q2));
-    float yaw = atan2f(
-        out->q1 * out->q2 + out->q0 * out->q3, 0.5f - out->q2 * out->q2 - out->q3 * out->q3);
+static void imu_record_flush(ImuThread* imu) {
+    if(imu->record_count == 0) return;
 
-    // Euler angles: rads to degrees
-    out->roll = roll / M_PI * 180.f;
-    out->pitch = pitch / M_PI * 180.f;
-    out->yaw = yaw / M_PI * 180.f;
+    size_t size = imu->record_count * sizeof(ICM42688PFifoPacket);
+    if(storage_file_write(imu->record_file, imu->record_buffer, size) != size) {
+        FURI_LOG_E(TAG, "Recording write failed");
+    }
+    imu->record_count = 0;
 }
 
-static void calibrate_gyro(ImuThread* imu) {
-    ICM42688PRawData data;
-    ICM42688PScaledData offset_scaled = {.x = 0.f, .y = 0.f, .z = 0.f};
+static void imu_record_close(File* file) {
+    storage_file_close(file);
+    storage_file_free(file);
+}
 
-    icm42688p_write_gyro_offset(imu->icm42688p, &offset_scaled);
-    furi_delay_ms(10);
+static void imu_record_switch(ImuThread* imu) {
+    File* next = atomic_exchange(&imu->record_next, NULL);
+    if(imu->record_file) {
+        imu_record_flush(imu);
+        imu_record_close(imu->record_file);
+    }
+    imu->record_file = next;
+}
 
-    int32_t avg_x = 0;
-    int32_t avg_y = 0;
-    int32_t avg_z = 0;
+static void imu_record_packet(ImuThread* imu, const ICM42688PFifoPacket* packet) {
+    imu->record_buffer[imu->record_count++] = *packet;
+    if(imu->record_count == IMU_RECORD_BUFFER) {
+        // the FIFO holds over a second of samples, enough to ride out a slow SD write
+        imu_record_flush(imu);
+    }
+}
+
+static void imu_sort(int16_t* values, size_t count) {
+    for(size_t i = 1; i < count; i++) {
+        int16_t value = values[i];
+        size_t j = i;
+        for(; j > 0 && values[j - 1] > value; j--) {
+            values[j] = values[j - 1];
+        }
+        values[j] = value;
+    }
+}
+
+static bool imu_gyro_axis_bias(int16_t* values, size_t count, float full_scale, float* bias) {
+    int16_t sorted[IMU_CALI_SAMPLES];
+    memcpy(sorted, values, count * sizeof(int16_t));
+    imu_sort(sorted, count);
+    int32_t median = sorted[count / 2];
 
-    for(uint8_t i = 0; i < IMU_CALI_AVG; i++) {
-        icm42688p_read_gyro_raw(imu->icm42688p, &data);
-        avg_x += data.x;
-        avg_y += data.y;
-        avg_z += data.z;
-        furi_delay_ms(2);
+    // median absolute deviation, a spread estimate that ignores the outliers themselves
+    for(size_t i = 0; i < count; i++) {
+        sorted[i] = (int16_t)MIN(abs(values[i] - median), INT16_MAX);
     }
+    imu_sort(sorted, count);
+    int32_t limit = IMU_CALI_OUTLIER_MAD * sorted[count / 2] + 1;
+
+    int32_t sum = 0;
+    int32_t kept = 0;
+    int32_t low = INT16_MAX;
+    int32_t high = INT16_MIN;
+    for(size_t i = 0; i < count; i++) {
+        if(abs(values[i] - median) <= limit) {
+            sum += values[i];
+            kept++;
+            low = MIN(low, values[i]);
+            high = MAX(high, values[i]);
+        }
+    }
+
+    // most samples rejected, or a wide spread of the rest, means the device was moving
+    float lsb_dps = full_scale / 32768.f;
+    if(kept < (int32_t)count / 2 || (float)(high - low) * lsb_dps > IMU_CALI_MOTION_DPS) {
+        return false;
+    }
+
+    *bias = (float)sum / (float)kept * lsb_dps;
+    return true;
+}
+
+static bool imu_gyro_bias(ImuThread* imu, ICM42688PScaledData* bias) {
+    int16_t values[3][IMU_CALI_SAMPLES];
+    for(size_t i = 0; i < imu->cali_count; i++) {
+        values[0][i] = imu->cali_packets[i].g_x;
+        values[1][i] = imu->cali_packets[i].g_y;
+        values[2][i] = imu->cali_packets[i].g_z;
+    }
+
+    float full_scale = icm42688p_gyro_get_full_scale(imu->icm42688p);
+    return imu_gyro_axis_bias(values[0], imu->cali_count, full_scale, &bias->x) &&
+           imu_gyro_axis_bias(values[1], imu->cali_count, full_scale, &bias->y) &&
+           imu_gyro_axis_bias(values[2], imu->cali_count, full_scale, &bias->z);
+}
+
+static bool imu_calibration_load(ImuGyroCalibration* calibration) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool loaded = storage_file_open(file, IMU_CALI_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                  storage_file_read(file, calibration, sizeof(ImuGyroCalibration)) ==
+                      sizeof(ImuGyroCalibration) &&
+                  calibration->magic == IMU_CALI_MAGIC;
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return loaded;
+}
+
+static void imu_calibration_save(const ImuGyroCalibration* calibration) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if(!storage_file_open(file, IMU_CALI_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) ||
+       storage_file_write(file, calibration, sizeof(ImuGyroCalibration)) !=
+           sizeof(ImuGyroCalibration)) {
+        FURI_LOG_W(TAG, "Calibration not saved");
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
 
-    data.x = avg_x / IMU_CALI_AVG;
-    data.y = avg_y / IMU_CALI_AVG;
-    data.z = avg_z / IMU_CALI_AVG;
+static void imu_calibration_apply(ImuThread* imu, ICM42688PScaledData* offset) {
+    imu->calibration.magic = IMU_CALI_MAGIC;
+    imu->calibration.x = offset->x;
+    imu->calibration.y = offset->y;
+    imu->calibration.z = offset->z;
+    imu->calibration.temperature = icm42688p_read_temp(imu->icm42688p);
 
-    icm42688p_apply_scale(&data, icm42688p_gyro_get_full_scale(imu->icm42688p), &offset_scaled);
     FURI_LOG_I(
         TAG,
         "Offsets: x %f, y %f, z %f",
-        (double)offset_scaled.x,
-        (double)offset_scaled.y,
-        (double)offset_scaled.z);
-    icm42688p_write_gyro_offset(imu->icm42688p, &offset_scaled);
+        (double)offset->x,
+        (double)offset->y,
+        (double)offset->z);
+    icm42688p_write_gyro_offset(imu->icm42688p, offset);
+    imu->cali_dirty = true;
+}
+
+static void imu_calibration_refine(ImuThread* imu, const ICM42688PFifoPacket* packet) {
+    imu->cali_packets[imu->cali_count++] = *packet;
+    if(imu->cali_count < IMU_CALI_SAMPLES) return;
+
+    // samples already have the cached offsets removed, what is left is the drift since then
+    ICM42688PScaledData residual;
+    if(imu_gyro_bias(imu, &residual)) {
+        ICM42688PScaledData offset = {
+            .x = imu->calibration.x + residual.x,
+            .y = imu->calibration.y + residual.y,
+            .z = imu->calibration.z + residual.z,
+        };
+        imu_calibration_apply(imu, &offset);
+        imu->cali_refine = false;
+    }
+
+    // when moving, try again with the next batch
+    imu->cali_count = 0;
+}
+
+static void calibrate_gyro(ImuThread* imu) {
+    // resume with the offsets of the last session, and refine them once the stream runs
+    ImuGyroCalibration* cached = &imu->cali_cached;
+    if(imu->cali_cached_valid &&
+       fabsf(cached->temperature - icm42688p_read_temp(imu->icm42688p)) < IMU_CALI_TEMP_DELTA) {
+        imu->calibration = *cached;
+        ICM42688PScaledData offset = {.x = cached->x, .y = cached->y, .z = cached->z};
+        icm42688p_write_gyro_offset(imu->icm42688p, &offset);
+        imu->cali_refine = true;
+        FURI_LOG_I(TAG, "Cached offsets loaded");
+        return;
+    }
+
+    // no usable cache: a burst of fast FIFO samples with the offsets cleared
+    ICM42688PScaledData offset = {.x = 0.f, .y = 0.f, .z = 0.f};
+    icm42688p_write_gyro_offset(imu->icm42688p, &offset);
+    icm42688p_accel_config(imu->icm42688p, AccelFullScale16G, IMU_CALI_RATE);
+    icm42688p_gyro_config(imu->icm42688p, GyroFullScale2000DPS, IMU_CALI_RATE);
+    icm42688_fifo_watermark_set(imu->icm42688p, IMU_CALI_SAMPLES);
+    icm42688_fifo_enable(imu->icm42688p, imu_irq_callback, imu);
+
+    uint32_t flags = furi_thread_flags_wait(ImuNewData, FuriFlagWaitAny, IMU_CALI_TIMEOUT_MS);
+    imu->cali_count = 0;
+    if(!(flags & FuriFlagError)) {
+        imu->cali_count =
+            icm42688_fifo_read_burst(imu->icm42688p, imu->cali_packets, IMU_CALI_SAMPLES);
+    }
+    icm42688_fifo_disable(imu->icm42688p);
+
+    if(imu->cali_count == IMU_CALI_SAMPLES && imu_gyro_bias(imu, &offset)) {
+        imu_calibration_apply(imu, &offset);
+    } else {
+        // moving at startup, keep refining from the stream until it holds still
+        FURI_LOG_W(TAG, "Device moving, calibration deferred");
+        imu->cali_refine = true;
+    }
+    imu->cali_count = 0;
 }
 
 // static float imu_angle_diff(float a, float b) {
@@ -123,6 +486,78 @@ static void calibrate_gyro(ImuThread* imu) {
 //     return diff;
 // }
 
+static const struct ImuRate* imu_rate_find(uint16_t rate_hz) {
+    for(size_t i = 0; i < COUNT_OF(imu_rates); i++) {
+        if(imu_rates[i].hz >= rate_hz) return &imu_rates[i];
+    }
+    return &imu_rates[COUNT_OF(imu_rates) - 1];
+}
+
+static void imu_stream_start(ImuThread* imu) {
+    bool low_power = imu->power == ImuPowerLowPower && imu->rate->hz <= IMU_LOW_POWER_RATE_MAX;
+    icm42688p_power_mode_set(imu->icm42688p, low_power ? PowerModeLowPower : PowerModeLowNoise);
+    icm42688p_accel_config(imu->icm42688p, AccelFullScale16G, imu->rate->rate);
+    icm42688p_gyro_config(imu->icm42688p, GyroFullScale2000DPS, imu->rate->rate);
+    imu->gyro_rad_scale = icm42688p_gyro_get_full_scale(imu->icm42688p) / 32768.f * M_PI / 180.f;
+    imu->accel_g_scale = icm42688p_accel_get_full_scale(imu->icm42688p) / 32768.f;
+    imu->sample_dt = 1.f / (float)imu->rate->hz;
+    imu->processed_data.timestamp_valid = false;
+
+    uint16_t watermark = imu->rate->hz * imu->latency_ms / 1000;
+    icm42688_fifo_watermark_set(
+        imu->icm42688p, MAX(1, MIN(watermark, ICM42688P_FIFO_WATERMARK_MAX)));
+    icm42688_fifo_enable(imu->icm42688p, imu_irq_callback, imu);
+    imu->still_since = furi_get_tick();
+}
+
+static void imu_idle_enter(ImuThread* imu) {
+    icm42688_fifo_disable(imu->icm42688p);
+
+    // wake-on-motion only needs a slow low power accel, the gyro is the big consumer
+    icm42688p_accel_config(imu->icm42688p, AccelFullScale16G, IMU_IDLE_RATE);
+    icm42688p_power_mode_set(imu->icm42688p, PowerModeAccelOnly);
+    if(!icm42688p_wom_enable(imu->icm42688p, IMU_WOM_THRESHOLD, imu_irq_callback, imu)) {
+        FURI_LOG_W(TAG, "Wake-on-motion unavailable, staying awake");
+        imu->wom_unsupported = true;
+        imu_stream_start(imu);
+        return;
+    }
+
+    FURI_LOG_D(TAG, "Idle");
+    imu->idle = true;
+    atomic_store(&imu->idle_state, true);
+}
+
+static void imu_idle_exit(ImuThread* imu) {
+    icm42688p_wom_disable(imu->icm42688p);
+    imu_stream_start(imu);
+
+    FURI_LOG_D(TAG, "Awake");
+    imu->idle = false;
+    atomic_store(&imu->idle_state, false);
+}
+
+static void imu_config_apply(ImuThread* imu) {
+    const struct ImuRate* rate = imu_rate_find(atomic_load(&imu->rate_request));
+    ImuPowerMode power = atomic_load(&imu->power_request);
+    uint16_t latency_ms = atomic_load(&imu->latency_request);
+    bool changed = rate != imu->rate || power != imu->power || latency_ms != imu->latency_ms;
+    imu->rate = rate;
+    imu->power = power;
+    imu->latency_ms = latency_ms;
+    imu->auto_idle = atomic_load(&imu->auto_idle_request);
+
+    if(imu->idle) {
+        // new settings are picked up on wake
+        if(!imu->auto_idle) {
+            imu_idle_exit(imu);
+        }
+    } else if(changed) {
+        icm42688_fifo_disable(imu->icm42688p);
+        imu_stream_start(imu);
+    }
+}
+
 static int32_t imu_thread(void* context) {
     furi_assert(context);
     ImuThread* imu = context;
@@ -134,14 +569,17 @@ static int32_t imu_thread(void* context) {
 
     calibrate_gyro(imu);
 
-    icm42688p_accel_config(imu->icm42688p, AccelFullScale16G, ACCEL_GYRO_RATE);
-    icm42688p_gyro_config(imu->icm42688p, GyroFullScale2000DPS, ACCEL_GYRO_RATE);
-
     imu->processed_data.q0 = 1.f;
     imu->processed_data.q1 = 0.f;
     imu->processed_data.q2 = 0.f;
     imu->processed_data.q3 = 0.f;
-    icm42688_fifo_enable(imu->icm42688p, imu_irq_callback, imu);
+    imu_publish(imu, furi_get_tick());
+
+    imu->rate = imu_rate_find(atomic_load(&imu->rate_request));
+    imu->power = atomic_load(&imu->power_request);
+    imu->latency_ms = atomic_load(&imu->latency_request);
+    imu->auto_idle = atomic_load(&imu->auto_idle_request);
+    imu_stream_start(imu);
 
     while(1) {
         uint32_t events = furi_thread_flags_wait(FLAGS_ALL, FuriFlagWaitAny, FuriWaitForever);
@@ -150,26 +588,73 @@ static int32_t imu_thread(void* context) {
             break;
         }
 
-        if(events & ImuNewData) {
+        if(events & ImuRecord) {
+            imu_record_switch(imu);
+        }
+
+        if(events & ImuConfig) {
+            imu_config_apply(imu);
+        }
+
+        if((events & ImuNewData) && imu->idle) {
+            // a FIFO IRQ from before the sleep can still be pending, only motion wakes
+            if(icm42688p_wom_triggered(imu->icm42688p)) {
+                imu_idle_exit(imu);
+            }
+        } else if(events & ImuNewData) {
+            // packets that arrive during the read are a little newer, the age errs on the old side
+            uint32_t sample_tick = atomic_load_explicit(&imu->irq_tick, memory_order_relaxed);
             uint16_t data_pending = icm42688_fifo_get_count(imu->icm42688p);
-            ICM42688PFifoPacket data;
-            while(data_pending--) {
-                icm42688_fifo_read(imu->icm42688p, &data);
-                imu_process_data(imu, &data);
+            ICM42688PFifoPacket data[IMU_FIFO_BURST];
+            while(data_pending > 0) {
+                uint16_t burst = MIN(data_pending, IMU_FIFO_BURST);
+                uint16_t read = icm42688_fifo_read_burst(imu->icm42688p, data, burst);
+                for(uint16_t i = 0; i < read; i++) {
+                    if(imu->record_file) {
+                        imu_record_packet(imu, &data[i]);
+                    }
+                    if(imu->cali_refine) {
+                        imu_calibration_refine(imu, &data[i]);
+                    }
+                    imu_process_data(imu, &data[i]);
+                }
+                if(read < burst) break; // FIFO ran dry early
+                data_pending -= burst;
+            }
+            imu_publish(imu, sample_tick);
+
+            uint32_t now = furi_get_tick();
+            if(imu->moved) {
+                imu->moved = false;
+                imu->still_since = now;
+            } else if(
+                imu->auto_idle && !imu->wom_unsupported && !imu->record_file &&
+                now - imu->still_since >= IMU_IDLE_AFTER_MS) {
+                imu_idle_enter(imu);
             }
         }
     }
 
-    icm42688_fifo_disable(imu->icm42688p);
+    if(imu->idle) {
+        icm42688p_wom_disable(imu->icm42688p);
+    } else {
+        icm42688_fifo_disable(imu->icm42688p);
+    }
+    imu_record_switch(imu);
 
     return 0;
 }
 
 ImuThread* imu_start(ICM42688P* icm42688p) {
     ImuThread* imu = malloc(sizeof(ImuThread));
+    memset(imu, 0, sizeof(ImuThread));
     imu->icm42688p = icm42688p;
+    imu->rate_request = IMU_RATE_DEFAULT;
+    imu->power_request = ImuPowerLowNoise;
+    imu->latency_request = IMU_FIFO_LATENCY_MS;
     imu->thread = furi_thread_alloc_ex("ImuThread", 4096, imu_thread, imu);
     imu->lefty = furi_hal_rtc_is_flag_set(FuriHalRtcFlagHandOrient);
+    imu->cali_cached_valid = imu_calibration_load(&imu->cali_cached);
     furi_thread_start(imu->thread);
 
     return imu;
@@ -183,6 +668,17 @@ void imu_stop(ImuThread* imu) {
     furi_thread_join(imu->thread);
     furi_thread_free(imu->thread);
 
+    // offsets found this session, for the next one
+    if(imu->cali_dirty) {
+        imu_calibration_save(&imu->calibration);
+    }
+
+    // a recording started right before the stop never reached the thread
+    File* pending = atomic_exchange(&imu->record_next, NULL);
+    if(pending) {
+        imu_record_close(pending);
+    }
+
     free(imu);
 }
 
@@ -201,7 +697,8 @@ static float imu_inv_sqrt(float number) {
 static void imu_madgwick_filter(
     ImuProcessedData* out,
     ICM42688PScaledData* accel,
-    ICM42688PScaledData* gyro) {
+    ICM42688PScaledData* gyro,
+    float dt) {
     float recipNorm;
     float s0, s1, s2, s3;
     float qDot1, qDot2, qDot3, qDot4;
@@ -258,10 +755,10 @@ static void imu_madgwick_filter(
     }
 
     // Integrate rate of change of quaternion to yield quaternion
-    out->q0 += qDot1 * (1.0f / FILTER_SAMPLE_FREQ);
-    out->q1 += qDot2 * (1.0f / FILTER_SAMPLE_FREQ);
-    out->q2 += qDot3 * (1.0f / FILTER_SAMPLE_FREQ);
-    out->q3 += qDot4 * (1.0f / FILTER_SAMPLE_FREQ);
+    out->q0 += qDot1 * dt;
+    out->q1 += qDot2 * dt;
+    out->q2 += qDot3 * dt;
+    out->q3 += qDot4 * dt;
 
     // Normalise quaternion
     recipNorm = imu_inv_sqrt(
@@ -279,10 +776,16 @@ struct Imu {
     ICM42688P* icm42688p;
     ImuThread* thread;
     bool present;
+    Storage* storage;
+
+    // Euler angles of the last sample read, converted once per sample generation
+    ImuEuler euler;
+    uint32_t euler_generation;
 };
 
 Imu* imu_alloc(void) {
     Imu* imu = malloc(sizeof(Imu));
+    memset(imu, 0, sizeof(Imu));
     imu->icm42688p_device = malloc(sizeof(FuriHalSpiBusHandle));
     memcpy(imu->icm42688p_device, &furi_hal_spi_bus_handle_external, sizeof(FuriHalSpiBusHandle));
     imu->icm42688p_device->cs = &gpio_ext_pc3;
@@ -301,6 +804,9 @@ void imu_free(Imu* imu) {
     if(imu->present) {
         imu_stop(imu->thread);
     }
+    if(imu->storage) {
+        furi_record_close(RECORD_STORAGE);
+    }
     icm42688p_deinit(imu->icm42688p);
     icm42688p_free(imu->icm42688p);
     free(imu->icm42688p_device);
@@ -311,18 +817,177 @@ bool imu_present(Imu* imu) {
     return imu->present;
 }
 
+static void imu_config_request(Imu* imu) {
+    furi_thread_flags_set(furi_thread_get_id(imu->thread->thread), ImuConfig);
+}
+
+void imu_rate_set(Imu* imu, uint16_t rate_hz) {
+    if(!imu->present) return;
+    atomic_store(&imu->thread->rate_request, rate_hz);
+    imu_config_request(imu);
+}
+
+void imu_power_mode_set(Imu* imu, ImuPowerMode mode) {
+    if(!imu->present) return;
+    atomic_store(&imu->thread->power_request, mode);
+    imu_config_request(imu);
+}
+
+void imu_latency_set(Imu* imu, uint16_t latency_ms) {
+    if(!imu->present) return;
+    atomic_store(&imu->thread->latency_request, latency_ms);
+    imu_config_request(imu);
+}
+
+void imu_auto_idle_set(Imu* imu, bool enabled) {
+    if(!imu->present) return;
+    atomic_store(&imu->thread->auto_idle_request, enabled);
+    imu_config_request(imu);
+}
+
+bool imu_idle(Imu* imu) {
+    return imu->present && atomic_load(&imu->thread->idle_state);
+}
+
+bool imu_record_start(Imu* imu, const char* path) {
+    if(!imu->present) return false;
+
+    if(!imu->storage) {
+        imu->storage = furi_record_open(RECORD_STORAGE);
+    }
+
+    File* file = storage_file_alloc(imu->storage);
+    if(!storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        FURI_LOG_E(TAG, "Cannot open recording %s", path);
+        storage_file_free(file);
+        return false;
+    }
+
+    File* previous = atomic_exchange(&imu->thread->record_next, file);
+    if(previous) {
+        imu_record_close(previous);
+    }
+    furi_thread_flags_set(furi_thread_get_id(imu->thread->thread), ImuRecord);
+    return true;
+}
+
+void imu_record_stop(Imu* imu) {
+    if(!imu->present) return;
+
+    File* pending = atomic_exchange(&imu->thread->record_next, NULL);
+    if(pending) {
+        imu_record_close(pending);
+    }
+    furi_thread_flags_set(furi_thread_get_id(imu->thread->thread), ImuRecord);
+}
+
+void imu_samples_enable(Imu* imu, bool enabled) {
+    if(!imu->present) return;
+    ImuSampleRing* ring = &imu->thread->samples;
+    if(enabled) {
+        // start from fresh samples, not the ones left over from last time
+        atomic_store_explicit(
+            &ring->head, atomic_load_explicit(&ring->tail, memory_order_acquire), memory_order_release);
+    }
+    atomic_store(&ring->enabled, enabled);
+}
+
+bool imu_sample_pop(Imu* imu, ImuSample* sample) {
+    if(!imu->present) return false;
+    ImuSampleRing* ring = &imu->thread->samples;
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if(head == tail) return false;
+
+    *sample = ring->items[head % IMU_SAMPLES_SIZE];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+uint32_t imu_samples_dropped(Imu* imu) {
+    if(!imu->present) return 0;
+    return atomic_load_explicit(&imu->thread->samples.dropped, memory_order_relaxed);
+}
+
+void imu_orientation_get(Imu* imu, ImuOrientation* orientation) {
+    imu_seqlock_read(&imu->thread->published, orientation);
+}
+
+static void imu_quaternion_to_euler(const ImuOrientation* q, bool lefty, ImuEuler* euler) {
+    // Quaternion to euler angles
+    float roll = atan2f(q->q0 * q->q1 + q->q2 * q->q3, 0.5f - q->q1 * q->q1 - q->q2 * q->q2);
+    float pitch = asinf(-2.0f * (q->q1 * q->q3 - q->q0 * q->q2));
+    float yaw = atan2f(q->q1 * q->q2 + q->q0 * q->q3, 0.5f - q->q2 * q->q2 - q->q3 * q->q3);
+
+    // Euler angles: rads to degrees
+    euler->roll = roll / M_PI * 180.f;
+    euler->pitch = pitch / M_PI * 180.f;
+    euler->yaw = yaw / M_PI * 180.f;
+    if(lefty) {
+        euler->pitch = -euler->pitch;
+        euler->yaw = -euler->yaw;
+    }
+}
+
+void imu_euler_get(Imu* imu, ImuEuler* euler) {
+    ImuOrientation q;
+    imu_orientation_get(imu, &q);
+
+    if(q.generation != imu->euler_generation) {
+        imu_quaternion_to_euler(&q, imu->thread->lefty, &imu->euler);
+        imu->euler_generation = q.generation;
+    }
+
+    *euler = imu->euler;
+}
+
+uint32_t imu_euler_predict(Imu* imu, uint32_t ahead_ms, ImuEuler* euler) {
+    ImuOrientation q;
+    imu_orientation_get(imu, &q);
+
+    // a stalled, sleeping or restarting stream would be extrapolated over seconds
+    uint32_t age_ms = furi_get_tick() - q.timestamp;
+    uint32_t latency_ms = atomic_load_explicit(&imu->thread->latency_request, memory_order_relaxed);
+    if(age_ms > IMU_PREDICT_MAX_LATENCIES * latency_ms) {
+        imu_euler_get(imu, euler);
+        return q.timestamp;
+    }
+
+    // one integration step over the time from the sample to the target, with the last rates
+    float dt = (float)(age_ms + ahead_ms) * 0.001f;
+    float half_dt = 0.5f * dt;
+    ImuOrientation predicted = q;
+    predicted.q0 += half_dt * (-q.q1 * q.gx - q.q2 * q.gy - q.q3 * q.gz);
+    predicted.q1 += half_dt * (q.q0 * q.gx + q.q2 * q.gz - q.q3 * q.gy);
+    predicted.q2 += half_dt * (q.q0 * q.gy - q.q1 * q.gz + q.q3 * q.gx);
+    predicted.q3 += half_dt * (q.q0 * q.gz + q.q1 * q.gy - q.q2 * q.gx);
+
+    float recipNorm = imu_inv_sqrt(
+        predicted.q0 * predicted.q0 + predicted.q1 * predicted.q1 + predicted.q2 * predicted.q2 +
+        predicted.q3 * predicted.q3);
+    predicted.q0 *= recipNorm;
+    predicted.q1 *= recipNorm;
+    predicted.q2 *= recipNorm;
+    predicted.q3 *= recipNorm;
+
+    imu_quaternion_to_euler(&predicted, imu->thread->lefty, euler);
+    return q.timestamp;
+}
+
 float imu_pitch_get(Imu* imu) {
-    // we pretend that reading a float is an atomic operation
-    return imu->thread->lefty ? -imu->thread->processed_data.pitch :
-                                imu->thread->processed_data.pitch;
+    ImuEuler euler;
+    imu_euler_get(imu, &euler);
+    return euler.pitch;
 }
 
 float imu_roll_get(Imu* imu) {
-    // we pretend that reading a float is an atomic operation
-    return imu->thread->processed_data.roll;
+    ImuEuler euler;
+    imu_euler_get(imu, &euler);
+    return euler.roll;
 }
 
 float imu_yaw_get(Imu* imu) {
-    // we pretend that reading a float is an atomic operation
-    return imu->thread->lefty ? -imu->thread->processed_data.yaw : imu->thread->processed_data.yaw;
-}
\ No newline at end of file
+    ImuEuler euler;
+    imu_euler_get(imu, &euler);
+    return euler.yaw;
+}
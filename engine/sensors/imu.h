@@ -1,13 +1,92 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
 
 typedef struct Imu Imu;
 
+// One complete orientation sample, as the sensor sees it
+typedef struct {
+    float q0;
+    float q1;
+    float q2;
+    float q3;
+    float gx; // body rates of the newest sample, rad/s
+    float gy;
+    float gz;
+    uint32_t timestamp; // furi tick of the sample
+    uint32_t generation; // changes with every published sample
+} ImuOrientation;
+
+// Orientation in degrees, pitch and yaw flipped for left-handed mode
+typedef struct {
+    float roll;
+    float pitch;
+    float yaw;
+} ImuEuler;
+
+// One sample from the stream, raw sensor values next to the filtered orientation
+typedef struct {
+    float ax; // accel in g
+    float ay;
+    float az;
+    float gx; // gyro in rad/s, calibrated
+    float gy;
+    float gz;
+    float q0; // orientation after this sample
+    float q1;
+    float q2;
+    float q3;
+    float dt; // seconds since the previous sample
+} ImuSample;
+
 Imu* imu_alloc(void);
 
 void imu_free(Imu* imu);
 
 bool imu_present(Imu* imu);
 
+typedef enum {
+    ImuPowerLowNoise, // lowest noise, the default
+    ImuPowerLowPower, // accel in low power mode, at rates up to 500 Hz
+} ImuPowerMode;
+
+// Sample rate in Hz, rounded up to one the sensor supports, 25 to 1000, default 100
+void imu_rate_set(Imu* imu, uint16_t rate_hz);
+
+void imu_power_mode_set(Imu* imu, ImuPowerMode mode);
+
+// Longest a sample waits in the sensor FIFO, default 40 ms, lower wakes the sensor thread more often
+void imu_latency_set(Imu* imu, uint16_t latency_ms);
+
+// Sleep in wake-on-motion after a while without rotation, orientation holds still meanwhile
+void imu_auto_idle_set(Imu* imu, bool enabled);
+
+bool imu_idle(Imu* imu);
+
+// Log raw FIFO packets to a file, for replay with the ICM42688P_REPLAY driver
+bool imu_record_start(Imu* imu, const char* path);
+
+void imu_record_stop(Imu* imu);
+
+// Consistent snapshot of the latest sample, never blocks the sensor thread
+void imu_orientation_get(Imu* imu, ImuOrientation* orientation);
+
+// Euler angles of the latest sample, converted at most once per sample, call from one thread
+void imu_euler_get(Imu* imu, ImuEuler* euler);
+
+// Euler angles extrapolated with the gyro rates to ahead_ms from now, to hide sensor and display lag.
+// A sample older than a few FIFO latencies is returned as is. Returns the furi tick of the sample.
+uint32_t imu_euler_predict(Imu* imu, uint32_t ahead_ms, ImuEuler* euler);
+
+// Queue every sample for imu_sample_pop, off by default, enabling drops what was queued before
+void imu_samples_enable(Imu* imu, bool enabled);
+
+// Oldest queued sample, false when none, call from one thread
+bool imu_sample_pop(Imu* imu, ImuSample* sample);
+
+// Samples lost to a full queue since start, read samples often enough to keep this still
+uint32_t imu_samples_dropped(Imu* imu);
+
 float imu_pitch_get(Imu* imu);
 
 float imu_roll_get(Imu* imu);
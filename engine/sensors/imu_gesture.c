@@ -0,0 +1,180 @@
+#include <furi.h>
+#include "imu_gesture.h"
+
+#define GRAVITY_TIME_S 0.3f // gravity follows slow tilts with this time constant
+
+#define TAP_G 1.5f // linear accel that starts a tap
+#define TAP_RELEASE_G 0.3f // and ends it
+#define TAP_MAX_S 0.06f // knocks are over quickly, a push lasts longer
+#define TAP_GYRO_MAX 2.f // rad/s, a knock barely turns the device
+
+#define FLICK_START 5.f // rad/s, ~290 dps
+#define FLICK_REST 1.f // rad/s
+#define FLICK_MAX_S 0.3f // longer turns are steering, not a flick
+
+#define SHAKE_G 1.2f // linear accel of a shake stroke
+#define SHAKE_STROKES 4 // direction changes for a shake
+#define SHAKE_GAP_S 0.4f // strokes further apart start over
+
+#define GESTURE_HOLDOFF_S 0.3f // nothing fires right after a gesture, the device is still settling
+
+typedef enum {
+    StrokeIdle,
+    StrokeActive, // crossed the start threshold, timing it
+    StrokeTooLong, // went on too long, wait for rest before trying again
+} StrokeState;
+
+struct ImuGesture {
+    float gravity[3];
+    bool gravity_valid;
+
+    StrokeState tap;
+    float tap_time;
+
+    StrokeState flick;
+    float flick_time;
+
+    float shake_direction[3];
+    uint8_t shake_strokes;
+    float shake_gap;
+
+    float holdoff;
+};
+
+ImuGesture* imu_gesture_alloc(void) {
+    ImuGesture* gesture = malloc(sizeof(ImuGesture));
+    imu_gesture_reset(gesture);
+    return gesture;
+}
+
+void imu_gesture_free(ImuGesture* gesture) {
+    free(gesture);
+}
+
+void imu_gesture_reset(ImuGesture* gesture) {
+    memset(gesture, 0, sizeof(ImuGesture));
+}
+
+static ImuGestureType imu_gesture_tap(ImuGesture* gesture, float linear, float rotation, float dt) {
+    switch(gesture->tap) {
+    case StrokeIdle:
+        if(linear > TAP_G && rotation < TAP_GYRO_MAX) {
+            gesture->tap = StrokeActive;
+            gesture->tap_time = 0;
+        }
+        break;
+    case StrokeActive:
+        gesture->tap_time += dt;
+        if(rotation >= TAP_GYRO_MAX || gesture->tap_time > TAP_MAX_S) {
+            gesture->tap = StrokeTooLong;
+        } else if(linear < TAP_RELEASE_G) {
+            gesture->tap = StrokeIdle;
+            return ImuGestureTap;
+        }
+        break;
+    case StrokeTooLong:
+        if(linear < TAP_RELEASE_G) gesture->tap = StrokeIdle;
+        break;
+    }
+    return ImuGestureNone;
+}
+
+static ImuGestureType imu_gesture_flick(ImuGesture* gesture, float rotation, float dt) {
+    switch(gesture->flick) {
+    case StrokeIdle:
+        if(rotation > FLICK_START) {
+            gesture->flick = StrokeActive;
+            gesture->flick_time = 0;
+        }
+        break;
+    case StrokeActive:
+        gesture->flick_time += dt;
+        if(gesture->flick_time > FLICK_MAX_S) {
+            gesture->flick = StrokeTooLong;
+        } else if(rotation < FLICK_REST) {
+            gesture->flick = StrokeIdle;
+            return ImuGestureFlick;
+        }
+        break;
+    case StrokeTooLong:
+        if(rotation < FLICK_REST) gesture->flick = StrokeIdle;
+        break;
+    }
+    return ImuGestureNone;
+}
+
+static ImuGestureType imu_gesture_shake(ImuGesture* gesture, const float* linear, float dt) {
+    gesture->shake_gap += dt;
+    if(gesture->shake_gap > SHAKE_GAP_S) {
+        gesture->shake_strokes = 0;
+    }
+
+    float magnitude_sq = linear[0] * linear[0] + linear[1] * linear[1] + linear[2] * linear[2];
+    if(magnitude_sq < SHAKE_G * SHAKE_G) return ImuGestureNone;
+
+    // a new stroke points against the last one, samples along the same stroke only keep it alive
+    float* last = gesture->shake_direction;
+    if(gesture->shake_strokes == 0 ||
+       linear[0] * last[0] + linear[1] * last[1] + linear[2] * last[2] < 0) {
+        memcpy(last, linear, sizeof(gesture->shake_direction));
+        gesture->shake_strokes++;
+    }
+    gesture->shake_gap = 0;
+
+    if(gesture->shake_strokes >= SHAKE_STROKES) {
+        gesture->shake_strokes = 0;
+        return ImuGestureShake;
+    }
+    return ImuGestureNone;
+}
+
+ImuGestureType imu_gesture_feed(ImuGesture* gesture, const ImuSample* sample) {
+    const float accel[3] = {sample->ax, sample->ay, sample->az};
+    float dt = sample->dt;
+
+    if(!gesture->gravity_valid) {
+        memcpy(gesture->gravity, accel, sizeof(gesture->gravity));
+        gesture->gravity_valid = true;
+    }
+
+    // Linear acceleration, what is left after taking out the slowly moving gravity
+    float linear[3];
+    for(size_t i = 0; i < 3; i++) {
+        linear[i] = accel[i] - gesture->gravity[i];
+    }
+    float linear_magnitude =
+        sqrtf(linear[0] * linear[0] + linear[1] * linear[1] + linear[2] * linear[2]);
+    float rotation =
+        sqrtf(sample->gx * sample->gx + sample->gy * sample->gy + sample->gz * sample->gz);
+
+    // a knock must not drag gravity along
+    if(gesture->tap != StrokeActive) {
+        float alpha = dt / (GRAVITY_TIME_S + dt);
+        for(size_t i = 0; i < 3; i++) {
+            gesture->gravity[i] += alpha * linear[i];
+        }
+    }
+
+    // every detector sees every sample, so none is left half way through a stroke
+    ImuGestureType tap = imu_gesture_tap(gesture, linear_magnitude, rotation, dt);
+    ImuGestureType flick = imu_gesture_flick(gesture, rotation, dt);
+    ImuGestureType shake = imu_gesture_shake(gesture, linear, dt);
+
+    if(gesture->holdoff > 0) {
+        gesture->holdoff -= dt;
+        return ImuGestureNone;
+    }
+
+    // the strokes of a shake look like taps and flicks on their own
+    ImuGestureType detected = ImuGestureNone;
+    if(shake != ImuGestureNone) {
+        detected = shake;
+    } else if(gesture->shake_strokes < 2) {
+        detected = flick != ImuGestureNone ? flick : tap;
+    }
+
+    if(detected != ImuGestureNone) {
+        gesture->holdoff = GESTURE_HOLDOFF_S;
+    }
+    return detected;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "imu.h"
+
+typedef struct ImuGesture ImuGesture;
+
+typedef enum {
+    ImuGestureNone,
+    ImuGestureTap, // short knock on the case
+    ImuGestureFlick, // quick turn of the wrist that comes back to rest
+    ImuGestureShake, // several fast back and forth moves
+} ImuGestureType;
+
+ImuGesture* imu_gesture_alloc(void);
+
+void imu_gesture_free(ImuGesture* gesture);
+
+// Forget the motion seen so far, for a gap in the sample stream
+void imu_gesture_reset(ImuGesture* gesture);
+
+// Feed one sample, constant time and memory, returns the gesture this sample completes
+ImuGestureType imu_gesture_feed(ImuGesture* gesture, const ImuSample* sample);
@@ -49,6 +49,40 @@ Sprite* sprite_alloc(const char* path) {
     return sprite;
 }
 
+typedef struct {
+    SpriteLoadCallback callback;
+    void* context;
+} SpriteLoad;
+
+static void sprite_load_callback(bool success, void* data, size_t size, void* context) {
+    SpriteLoad* load = context;
+    Sprite* sprite = data;
+    if(!success || size < sizeof(Sprite)) {
+        SPRITE_E("Failed to load sprite");
+        free(sprite);
+        sprite = NULL;
+    }
+    load->callback(sprite, load->context);
+    free(load);
+}
+
+bool sprite_alloc_async(
+    IoWorker* worker,
+    const char* path,
+    SpriteLoadCallback callback,
+    void* context) {
+    SpriteLoad* load = malloc(sizeof(SpriteLoad));
+    load->callback = callback;
+    load->context = context;
+
+    // skip the size header, the rest of the file is the sprite itself
+    if(!io_worker_read(worker, path, sizeof(uint32_t), 0, sprite_load_callback, load)) {
+        free(load);
+        return false;
+    }
+    return true;
+}
+
 void sprite_free(Sprite* sprite) {
     free(sprite);
 }
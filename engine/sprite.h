@@ -2,6 +2,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <gui/canvas.h>
+#include "io_worker.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,6 +15,25 @@ typedef struct Sprite Sprite;
  */
 Sprite* sprite_alloc(const char* path);
 
+/** Sprite load callback
+ * @param sprite Sprite instance or NULL, if failed
+ * @param context callback context
+ */
+typedef void (*SpriteLoadCallback)(Sprite* sprite, void* context);
+
+/** Load a sprite on the I/O worker
+ * @param worker IoWorker instance
+ * @param path sprite file path
+ * @param callback called from io_worker_poll when the sprite is loaded
+ * @param context callback context
+ * @return true if the load was queued
+ */
+bool sprite_alloc_async(
+    IoWorker* worker,
+    const char* path,
+    SpriteLoadCallback callback,
+    void* context);
+
 /** Sprite deallocator
  * @param sprite Sprite instance
  */
@@ -0,0 +1,111 @@
+#include "task_queue.h"
+#include <m-array.h>
+
+#ifdef ENGINE_HOST
+#include <time.h>
+#else
+#include <furi.h>
+#endif
+
+typedef struct {
+    TaskCallback callback; // NULL once cancelled
+    void* context;
+} Task;
+
+ARRAY_DEF(TaskArray, Task, M_POD_OPLIST);
+
+struct TaskQueue {
+    TaskArray_t tasks;
+    size_t cursor;
+};
+
+#ifdef ENGINE_HOST
+static uint32_t task_queue_clock_get(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint32_t)(time.tv_sec * 1000000000ull + time.tv_nsec);
+}
+
+static uint32_t task_queue_clock_from_us(uint32_t us) {
+    return us * 1000;
+}
+#else
+static uint32_t task_queue_clock_get(void) {
+    return DWT->CYCCNT;
+}
+
+static uint32_t task_queue_clock_from_us(uint32_t us) {
+    return us * (SystemCoreClock / 1000000);
+}
+#endif
+
+TaskQueue* task_queue_alloc(void) {
+    TaskQueue* queue = malloc(sizeof(TaskQueue));
+    TaskArray_init(queue->tasks);
+    queue->cursor = 0;
+    return queue;
+}
+
+void task_queue_free(TaskQueue* queue) {
+    TaskArray_clear(queue->tasks);
+    free(queue);
+}
+
+void task_queue_push(TaskQueue* queue, TaskCallback callback, void* context) {
+    TaskArray_push_back(queue->tasks, (Task){.callback = callback, .context = context});
+}
+
+void task_queue_cancel(TaskQueue* queue, void* context) {
+    // only mark here, the run loop may be in the middle of the array
+    for(size_t i = 0; i < TaskArray_size(queue->tasks); i++) {
+        Task* task = TaskArray_get(queue->tasks, i);
+        if(task->context == context) {
+            task->callback = NULL;
+        }
+    }
+}
+
+bool task_queue_empty(const TaskQueue* queue) {
+    for(size_t i = 0; i < TaskArray_size(queue->tasks); i++) {
+        if(TaskArray_cget(queue->tasks, i)->callback) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void task_queue_run(TaskQueue* queue, uint32_t budget_us) {
+    if(budget_us == 0) {
+        return;
+    }
+
+    uint32_t start = task_queue_clock_get();
+    uint32_t budget = task_queue_clock_from_us(budget_us);
+    bool stepped = false;
+
+    while(!TaskArray_empty_p(queue->tasks)) {
+        if(queue->cursor >= TaskArray_size(queue->tasks)) {
+            queue->cursor = 0;
+        }
+
+        Task task = *TaskArray_get(queue->tasks, queue->cursor);
+        if(!task.callback) {
+            TaskArray_erase(queue->tasks, queue->cursor);
+            continue;
+        }
+
+        if(stepped && task_queue_clock_get() - start >= budget) {
+            break;
+        }
+
+        bool done = task.callback(task.context);
+        stepped = true;
+
+        // the step may have pushed tasks, but never removes them, so the cursor still points at it
+        if(done) {
+            TaskArray_erase(queue->tasks, queue->cursor);
+        } else {
+            queue->cursor++;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Queue of resumable tasks for work that can be spread over several frames.
+ * Tasks run one step at a time, round-robin, until the time budget is spent.
+ */
+typedef struct TaskQueue TaskQueue;
+
+/** Task step callback
+ * Does a bounded slice of work and keeps its progress in the context
+ * @param context task context
+ * @return true when the task is finished and can be dropped
+ */
+typedef bool (*TaskCallback)(void* context);
+
+/** Allocate a task queue
+ * @return TaskQueue*  TaskQueue instance
+ */
+TaskQueue* task_queue_alloc(void);
+
+/** Free the task queue, unfinished tasks are dropped
+ * @param queue TaskQueue instance
+ */
+void task_queue_free(TaskQueue* queue);
+
+/** Add a task to the queue
+ * @param queue TaskQueue instance
+ * @param callback step callback
+ * @param context task context, must stay valid until the task finishes or is cancelled
+ */
+void task_queue_push(TaskQueue* queue, TaskCallback callback, void* context);
+
+/** Drop every task with the given context, safe to call from a task step
+ * @param queue TaskQueue instance
+ * @param context task context
+ */
+void task_queue_cancel(TaskQueue* queue, void* context);
+
+/** Check if there are tasks left
+ * @param queue TaskQueue instance
+ * @return true if the queue has no tasks
+ */
+bool task_queue_empty(const TaskQueue* queue);
+
+/** Run task steps until the budget is spent
+ * At least one step runs when the budget is not 0, so every task keeps progressing
+ * @param queue TaskQueue instance
+ * @param budget_us time budget in microseconds
+ */
+void task_queue_run(TaskQueue* queue, uint32_t budget_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,201 @@
+#include "timer_wheel.h"
+#include <furi.h>
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_MAX_DELAY ((1ul << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1)
+#define TIMER_WHEEL_POOL_CHUNK_ITEMS 8
+
+typedef struct TimerWheelNode {
+    struct TimerWheelNode* next;
+    uint32_t expires;
+    uint32_t period;
+    TimerId id;
+    TimerWheelCallback callback; // NULL once cancelled
+    void* owner;
+    uint32_t value;
+} TimerWheelNode;
+
+struct TimerWheel {
+    TimerWheelNode* slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    TimerWheelNode* firing; // expired timers detached from their slot while callbacks run
+    ArenaPool* pool;
+    uint32_t now;
+    TimerId next_id;
+    uint32_t count;
+};
+
+TimerWheel* timer_wheel_alloc(Arena* arena, uint32_t now) {
+    TimerWheel* wheel = arena_push(arena, sizeof(TimerWheel));
+    wheel->pool = arena_pool_alloc(arena, sizeof(TimerWheelNode), TIMER_WHEEL_POOL_CHUNK_ITEMS);
+    wheel->firing = NULL;
+    wheel->now = now;
+    wheel->next_id = 1;
+    wheel->count = 0;
+    return wheel;
+}
+
+static void timer_wheel_insert(TimerWheel* wheel, TimerWheelNode* node) {
+    uint32_t delta = node->expires - wheel->now;
+
+    // the level is picked by how far away the expiry is, the slot by the expiry itself
+    size_t level = 0;
+    while(level < TIMER_WHEEL_LEVELS - 1 &&
+          delta >= (1ul << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    size_t slot = (node->expires >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+
+    node->next = wheel->slots[level][slot];
+    wheel->slots[level][slot] = node;
+}
+
+TimerId timer_wheel_schedule(
+    TimerWheel* wheel,
+    uint32_t delay,
+    uint32_t period,
+    TimerWheelCallback callback,
+    void* owner,
+    uint32_t value) {
+    TimerWheelNode* node = arena_pool_get(wheel->pool);
+    node->expires = wheel->now + MIN(MAX(delay, 1ul), TIMER_WHEEL_MAX_DELAY);
+    node->period = MIN(period, TIMER_WHEEL_MAX_DELAY);
+    node->id = wheel->next_id++;
+    node->callback = callback;
+    node->owner = owner;
+    node->value = value;
+
+    if(wheel->next_id == TIMER_ID_NONE) {
+        wheel->next_id = 1;
+    }
+
+    timer_wheel_insert(wheel, node);
+    wheel->count++;
+    return node->id;
+}
+
+static void* timer_wheel_cancel_in(TimerWheelNode* list, TimerId id) {
+    for(TimerWheelNode* node = list; node; node = node->next) {
+        if(node->id == id && node->callback) {
+            // unlinked lazily, when its slot comes around
+            node->callback = NULL;
+            return node->owner;
+        }
+    }
+    return NULL;
+}
+
+void* timer_wheel_cancel(TimerWheel* wheel, TimerId id) {
+    void* owner = timer_wheel_cancel_in(wheel->firing, id);
+    for(size_t level = 0; !owner && level < TIMER_WHEEL_LEVELS; level++) {
+        for(size_t slot = 0; !owner && slot < TIMER_WHEEL_SLOTS; slot++) {
+            owner = timer_wheel_cancel_in(wheel->slots[level][slot], id);
+        }
+    }
+    return owner;
+}
+
+static void timer_wheel_cancel_owner_in(TimerWheelNode* list, void* owner) {
+    for(TimerWheelNode* node = list; node; node = node->next) {
+        if(node->owner == owner) {
+            node->callback = NULL;
+        }
+    }
+}
+
+void timer_wheel_cancel_owner(TimerWheel* wheel, void* owner) {
+    timer_wheel_cancel_owner_in(wheel->firing, owner);
+    for(size_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for(size_t slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            timer_wheel_cancel_owner_in(wheel->slots[level][slot], owner);
+        }
+    }
+}
+
+void timer_wheel_reset(TimerWheel* wheel) {
+    for(size_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for(size_t slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            wheel->slots[level][slot] = NULL;
+        }
+    }
+
+    wheel->count = 0;
+    if(wheel->firing) {
+        // called from a callback, the detached timers are released as the fire loop unwinds
+        for(TimerWheelNode* node = wheel->firing; node; node = node->next) {
+            node->callback = NULL;
+            wheel->count++;
+        }
+    } else {
+        arena_pool_reset(wheel->pool);
+    }
+}
+
+static void timer_wheel_cascade(TimerWheel* wheel, size_t level, size_t slot) {
+    TimerWheelNode* node = wheel->slots[level][slot];
+    wheel->slots[level][slot] = NULL;
+    while(node) {
+        TimerWheelNode* next = node->next;
+        if(node->callback) {
+            timer_wheel_insert(wheel, node);
+        } else {
+            arena_pool_put(wheel->pool, node);
+            wheel->count--;
+        }
+        node = next;
+    }
+}
+
+static void timer_wheel_fire(TimerWheel* wheel, void* context) {
+    size_t slot = wheel->now & TIMER_WHEEL_SLOT_MASK;
+    wheel->firing = wheel->slots[0][slot];
+    wheel->slots[0][slot] = NULL;
+
+    while(wheel->firing) {
+        TimerWheelNode* node = wheel->firing;
+        if(node->callback) {
+            TimerWheelCallback callback = node->callback;
+            bool done = node->period == 0;
+            if(done) {
+                // a one-shot is over as it fires, cancelling it from its own callback finds nothing
+                node->callback = NULL;
+            }
+            callback(context, node->owner, node->value, node->id, done);
+        }
+
+        // the callback may have cancelled this timer or reset the wheel
+        wheel->firing = node->next;
+        if(node->callback && node->period > 0) {
+            node->expires = wheel->now + node->period;
+            timer_wheel_insert(wheel, node);
+        } else {
+            arena_pool_put(wheel->pool, node);
+            wheel->count--;
+        }
+    }
+}
+
+void timer_wheel_advance(TimerWheel* wheel, uint32_t now, void* context) {
+    while(wheel->now != now) {
+        if(wheel->count == 0) {
+            // nothing to fire, skip the idle ticks
+            wheel->now = now;
+            break;
+        }
+
+        wheel->now++;
+
+        // when a level wraps, the next slot of the level above moves down
+        for(size_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if(wheel->now & ((1ul << (TIMER_WHEEL_SLOT_BITS * level)) - 1)) {
+                break;
+            }
+            size_t slot = (wheel->now >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+            timer_wheel_cascade(wheel, level, slot);
+        }
+
+        timer_wheel_fire(wheel, context);
+    }
+}
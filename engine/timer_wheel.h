@@ -0,0 +1,85 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Hierarchical timer wheel.
+ * Four levels of 64 slots cover delays up to 2^24 ticks. Scheduling is O(1) and
+ * advancing costs the elapsed ticks plus the timers that expire, however many are pending.
+ * The tick unit is up to the owner, levels drive it in milliseconds.
+ */
+typedef struct TimerWheel TimerWheel;
+
+/** Timer id, 0 is never a valid timer */
+typedef uint32_t TimerId;
+
+#define TIMER_ID_NONE 0
+
+/** Timer callback
+ * @param context context passed to timer_wheel_advance
+ * @param owner timer owner
+ * @param value value given when scheduling
+ * @param id timer id
+ * @param done true if the timer will not fire again
+ */
+typedef void (
+    *TimerWheelCallback)(void* context, void* owner, uint32_t value, TimerId id, bool done);
+
+/** Allocate a timer wheel inside an arena
+ * @param arena arena for the wheel and its timers, the wheel is freed with it
+ * @param now current time in ticks
+ * @return TimerWheel*  TimerWheel instance
+ */
+TimerWheel* timer_wheel_alloc(Arena* arena, uint32_t now);
+
+/** Schedule a timer
+ * @param wheel TimerWheel instance
+ * @param delay ticks until the first expiry, 0 expires on the next tick
+ * @param period ticks between repeats, 0 for a one-shot timer
+ * @param callback expiry callback
+ * @param owner owner, used to cancel all timers of an owner at once
+ * @param value value passed to the callback
+ * @return TimerId  timer id
+ */
+TimerId timer_wheel_schedule(
+    TimerWheel* wheel,
+    uint32_t delay,
+    uint32_t period,
+    TimerWheelCallback callback,
+    void* owner,
+    uint32_t value);
+
+/** Cancel a timer, safe to call from a timer callback
+ * Cost grows with the number of pending timers, a one-shot that is firing is no longer pending
+ * @param wheel TimerWheel instance
+ * @param id timer id
+ * @return void*  owner of the cancelled timer, NULL if it was not pending
+ */
+void* timer_wheel_cancel(TimerWheel* wheel, TimerId id);
+
+/** Cancel every timer of an owner, safe to call from a timer callback
+ * @param wheel TimerWheel instance
+ * @param owner owner
+ */
+void timer_wheel_cancel_owner(TimerWheel* wheel, void* owner);
+
+/** Drop every timer
+ * @param wheel TimerWheel instance
+ */
+void timer_wheel_reset(TimerWheel* wheel);
+
+/** Advance the wheel and call the callbacks of the expired timers
+ * @param wheel TimerWheel instance
+ * @param now current time in ticks
+ * @param context context passed to the callbacks
+ */
+void timer_wheel_advance(TimerWheel* wheel, uint32_t now, void* context);
+
+#ifdef __cplusplus
+}
+#endif
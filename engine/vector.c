@@ -2,61 +2,38 @@
 #include <math.h>
 #include <float.h>
 
-#undef vector_add
-#undef vector_sub
-#undef vector_mul
-#undef vector_div
-
-Vector vector_add(Vector a, Vector b) {
-    return (Vector){.x = a.x + b.x, .y = a.y + b.y};
-}
-
-Vector vector_sub(Vector a, Vector b) {
-    return (Vector){.x = a.x - b.x, .y = a.y - b.y};
-}
-
-Vector vector_mul(Vector a, Vector b) {
-    return (Vector){.x = a.x * b.x, .y = a.y * b.y};
-}
-
-Vector vector_div(Vector a, Vector b) {
-    return (Vector){.x = a.x / b.x, .y = a.y / b.y};
-}
-
-Vector vector_addf(Vector a, float b) {
-    return (Vector){.x = a.x + b, .y = a.y + b};
-}
-
-Vector vector_subf(Vector a, float b) {
-    return (Vector){.x = a.x - b, .y = a.y - b};
-}
-
-Vector vector_mulf(Vector a, float b) {
-    return (Vector){.x = a.x * b, .y = a.y * b};
+Vector vector_rand(Rng* rng) {
+    float x = rng_float(rng);
+    float y = rng_float(rng);
+    return (Vector){x, y};
 }
 
-Vector vector_divf(Vector a, float b) {
-    return (Vector){.x = a.x / b, .y = a.y / b};
+void vector_add_array(Vector* out, const Vector* a, const Vector* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        out[i].x = a[i].x + b[i].x;
+        out[i].y = a[i].y + b[i].y;
+    }
 }
 
-float vector_length(Vector v) {
-    return sqrtf(v.x * v.x + v.y * v.y);
+void vector_scale_array(Vector* out, const Vector* in, float scale, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        out[i].x = in[i].x * scale;
+        out[i].y = in[i].y * scale;
+    }
 }
 
-Vector vector_normalize(Vector v) {
-    float length = vector_length(v);
-    if(length < FLT_EPSILON) {
-        return (Vector){0, 0};
+void vector_length_sq_array(float* out, const Vector* in, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        out[i] = in[i].x * in[i].x + in[i].y * in[i].y;
     }
-    return (Vector){v.x / length, v.y / length};
 }
 
-float vector_dot(Vector a, Vector b) {
-    return a.x * b.x + a.y * b.y;
+void vector_normalize_array(Vector* out, const Vector* in, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        float length = sqrtf(in[i].x * in[i].x + in[i].y * in[i].y);
+        // select instead of branching keeps the loop vectorizable
+        float scale = length < FLT_EPSILON ? 0.0f : 1.0f / length;
+        out[i].x = in[i].x * scale;
+        out[i].y = in[i].y * scale;
+    }
 }
-
-Vector vector_rand() {
-    float x = (rand() % __INT_MAX__) / (float)__INT_MAX__;
-    float y = (rand() % __INT_MAX__) / (float)__INT_MAX__;
-    return (Vector){x, y};
-}
\ No newline at end of file
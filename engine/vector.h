@@ -1,5 +1,8 @@
 #pragma once
 #include <m-core.h>
+#include <math.h>
+#include <float.h>
+#include "rng.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,29 +15,78 @@ typedef struct {
 
 #define VECTOR_ZERO ((Vector){0, 0})
 
-Vector vector_add(Vector a, Vector b);
+static inline Vector vector_add(Vector a, Vector b) {
+    return (Vector){.x = a.x + b.x, .y = a.y + b.y};
+}
 
-Vector vector_sub(Vector a, Vector b);
+static inline Vector vector_sub(Vector a, Vector b) {
+    return (Vector){.x = a.x - b.x, .y = a.y - b.y};
+}
 
-Vector vector_mul(Vector a, Vector b);
+static inline Vector vector_mul(Vector a, Vector b) {
+    return (Vector){.x = a.x * b.x, .y = a.y * b.y};
+}
 
-Vector vector_div(Vector a, Vector b);
+static inline Vector vector_div(Vector a, Vector b) {
+    return (Vector){.x = a.x / b.x, .y = a.y / b.y};
+}
 
-Vector vector_addf(Vector a, float b);
+static inline Vector vector_addf(Vector a, float b) {
+    return (Vector){.x = a.x + b, .y = a.y + b};
+}
 
-Vector vector_subf(Vector a, float b);
+static inline Vector vector_subf(Vector a, float b) {
+    return (Vector){.x = a.x - b, .y = a.y - b};
+}
 
-Vector vector_mulf(Vector a, float b);
+static inline Vector vector_mulf(Vector a, float b) {
+    return (Vector){.x = a.x * b, .y = a.y * b};
+}
 
-Vector vector_divf(Vector a, float b);
+static inline Vector vector_divf(Vector a, float b) {
+    return (Vector){.x = a.x / b, .y = a.y / b};
+}
 
-float vector_length(Vector v);
+static inline float vector_length_sq(Vector v) {
+    return v.x * v.x + v.y * v.y;
+}
 
-Vector vector_normalize(Vector v);
+static inline float vector_length(Vector v) {
+    return sqrtf(vector_length_sq(v));
+}
 
-float vector_dot(Vector a, Vector b);
+static inline Vector vector_normalize(Vector v) {
+    float length = vector_length(v);
+    if(length < FLT_EPSILON) {
+        return (Vector){0, 0};
+    }
+    return (Vector){v.x / length, v.y / length};
+}
+
+static inline float vector_dot(Vector a, Vector b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+/** Random vector with components in [0, 1) */
+Vector vector_rand(Rng* rng);
+
+/**
+ * Batched operations over arrays of vectors.
+ * Output may be the same array as an input, loops are simple enough
+ * for the compiler to vectorize.
+ */
 
-Vector vector_rand();
+/** out[i] = a[i] + b[i] */
+void vector_add_array(Vector* out, const Vector* a, const Vector* b, size_t count);
+
+/** out[i] = in[i] * scale */
+void vector_scale_array(Vector* out, const Vector* in, float scale, size_t count);
+
+/** out[i] = squared length of in[i] */
+void vector_length_sq_array(float* out, const Vector* in, size_t count);
+
+/** out[i] = in[i] normalized, zero for zero-length vectors */
+void vector_normalize_array(Vector* out, const Vector* in, size_t count);
 
 #define VECTOR_SELECT(func1, func2, a, b) \
     _Generic(                             \
@@ -53,4 +105,4 @@ Vector vector_rand();
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
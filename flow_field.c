@@ -0,0 +1,201 @@
+#include "flow_field.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FLOW_SLICE_CELLS 256 // cells settled per task step
+
+#define FLOW_TARGET 8 // the target cell itself
+#define FLOW_NONE 0xFF // land, or not reached
+
+#define FLOW_DIAGONAL 0.70710678f
+
+// Neighbour offsets, orthogonal first so they win ties over diagonals
+static const int8_t flow_dx[8] = {1, 0, -1, 0, 1, -1, -1, 1};
+static const int8_t flow_dy[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+
+// Step from a cell to the neighbour it was reached from, indexed by the direction stored in the cell
+static const Vector flow_steps[8] = {
+    {-1, 0},
+    {0, -1},
+    {1, 0},
+    {0, 1},
+    {-FLOW_DIAGONAL, -FLOW_DIAGONAL},
+    {FLOW_DIAGONAL, -FLOW_DIAGONAL},
+    {FLOW_DIAGONAL, FLOW_DIAGONAL},
+    {-FLOW_DIAGONAL, FLOW_DIAGONAL},
+};
+
+struct FlowField {
+    const bool* collision_map;
+    uint16_t map_width;
+    uint16_t map_height;
+    uint16_t width; // in cells
+    uint16_t height;
+    TaskQueue* tasks;
+
+    uint8_t* front; // complete field, read by agents
+    uint8_t* back; // field being built
+    uint8_t* water; // one bit per cell, taken from the collision map on alloc and invalidate
+
+    // breadth-first queue, every cell goes in at most once so it never wraps
+    uint16_t* queue;
+    uint16_t queue_head;
+    uint16_t queue_tail;
+
+    uint16_t target; // cell of the target in use, or being built toward
+    uint16_t target_next; // cell of the latest target
+    bool targeted; // target_next was set
+    bool building;
+    bool rebuild; // start over when the current build is done
+};
+
+static bool flow_field_water_scan(const FlowField* field, uint16_t cx, uint16_t cy) {
+    uint16_t x0 = cx * FLOW_FIELD_CELL;
+    uint16_t y0 = cy * FLOW_FIELD_CELL;
+    for(uint16_t y = y0; y < y0 + FLOW_FIELD_CELL && y < field->map_height; y++) {
+        for(uint16_t x = x0; x < x0 + FLOW_FIELD_CELL && x < field->map_width; x++) {
+            if(field->collision_map[y * field->map_width + x]) return false;
+        }
+    }
+    return true;
+}
+
+static void flow_field_water_update(FlowField* field) {
+    memset(field->water, 0, (field->width * field->height + 7) / 8);
+    for(uint16_t cy = 0; cy < field->height; cy++) {
+        for(uint16_t cx = 0; cx < field->width; cx++) {
+            if(flow_field_water_scan(field, cx, cy)) {
+                uint16_t cell = cy * field->width + cx;
+                field->water[cell / 8] |= 1 << (cell % 8);
+            }
+        }
+    }
+}
+
+static bool flow_field_water(const FlowField* field, uint16_t cx, uint16_t cy) {
+    uint16_t cell = cy * field->width + cx;
+    return field->water[cell / 8] & (1 << (cell % 8));
+}
+
+static void flow_field_begin(FlowField* field) {
+    field->target = field->target_next;
+    field->rebuild = false;
+    memset(field->back, FLOW_NONE, field->width * field->height);
+
+    // the target seeds the search even if its cell is partly land, agents still get to it
+    field->back[field->target] = FLOW_TARGET;
+    field->queue[0] = field->target;
+    field->queue_head = 0;
+    field->queue_tail = 1;
+}
+
+static bool flow_field_step(void* context) {
+    FlowField* field = context;
+
+    for(uint16_t settled = 0; settled < FLOW_SLICE_CELLS; settled++) {
+        if(field->queue_head == field->queue_tail) {
+            uint8_t* front = field->front;
+            field->front = field->back;
+            field->back = front;
+
+            // the target moved during the build, follow it with another one
+            if(field->rebuild) {
+                flow_field_begin(field);
+                return false;
+            }
+            field->building = false;
+            return true;
+        }
+
+        uint16_t cell = field->queue[field->queue_head++];
+        int16_t cx = cell % field->width;
+        int16_t cy = cell / field->width;
+
+        for(uint8_t i = 0; i < 8; i++) {
+            int16_t nx = cx + flow_dx[i];
+            int16_t ny = cy + flow_dy[i];
+            if(nx < 0 || ny < 0 || nx >= field->width || ny >= field->height) continue;
+
+            uint16_t next = ny * field->width + nx;
+            if(field->back[next] != FLOW_NONE || !flow_field_water(field, nx, ny)) continue;
+
+            // no cutting corners, both cells beside a diagonal step must be water too
+            if(i >= 4 && (!flow_field_water(field, nx, cy) || !flow_field_water(field, cx, ny))) {
+                continue;
+            }
+
+            field->back[next] = i;
+            field->queue[field->queue_tail++] = next;
+        }
+    }
+    return false;
+}
+
+static void flow_field_request(FlowField* field) {
+    if(field->building) {
+        field->rebuild = true;
+        return;
+    }
+    field->building = true;
+    flow_field_begin(field);
+    task_queue_push(field->tasks, flow_field_step, field);
+}
+
+FlowField* flow_field_alloc(const bool* collision_map, uint16_t width, uint16_t height, TaskQueue* tasks) {
+    FlowField* field = malloc(sizeof(FlowField));
+    memset(field, 0, sizeof(FlowField));
+    field->collision_map = collision_map;
+    field->map_width = width;
+    field->map_height = height;
+    field->width = (width + FLOW_FIELD_CELL - 1) / FLOW_FIELD_CELL;
+    field->height = (height + FLOW_FIELD_CELL - 1) / FLOW_FIELD_CELL;
+    field->tasks = tasks;
+
+    size_t cells = field->width * field->height;
+    furi_check(cells <= UINT16_MAX, "Flow field too large");
+    field->front = malloc(cells);
+    field->back = malloc(cells);
+    field->queue = malloc(cells * sizeof(uint16_t));
+    field->water = malloc((cells + 7) / 8);
+    memset(field->front, FLOW_NONE, cells);
+    flow_field_water_update(field);
+    return field;
+}
+
+void flow_field_free(FlowField* field) {
+    free(field->front);
+    free(field->back);
+    free(field->queue);
+    free(field->water);
+    free(field);
+}
+
+void flow_field_target_set(FlowField* field, float x, float y) {
+    int32_t cx = MIN(MAX((int32_t)x / FLOW_FIELD_CELL, 0), field->width - 1);
+    int32_t cy = MIN(MAX((int32_t)y / FLOW_FIELD_CELL, 0), field->height - 1);
+    uint16_t target = cy * field->width + cx;
+    if(field->targeted && target == field->target_next) return;
+
+    field->targeted = true;
+    field->target_next = target;
+    flow_field_request(field);
+}
+
+void flow_field_invalidate(FlowField* field) {
+    flow_field_water_update(field);
+    if(!field->targeted) return;
+    flow_field_request(field);
+}
+
+bool flow_field_direction_get(const FlowField* field, float x, float y, Vector* direction) {
+    if(x < 0 || y < 0) return false;
+    uint16_t cx = (uint16_t)x / FLOW_FIELD_CELL;
+    uint16_t cy = (uint16_t)y / FLOW_FIELD_CELL;
+    if(cx >= field->width || cy >= field->height) return false;
+
+    uint8_t step = field->front[cy * field->width + cx];
+    if(step >= FLOW_TARGET) return false;
+
+    *direction = flow_steps[step];
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "engine/engine.h"
+
+// Flow field over the water of a collision map, every water cell points one step closer
+// to the target. Fields are built breadth-first in slices on the engine task queue, into a
+// back buffer that is swapped in when complete, so readers always see a whole field and
+// any number of agents steer with one lookup each.
+typedef struct FlowField FlowField;
+
+#define FLOW_FIELD_CELL 2 // map pixels per field cell side, a cell is water when all of them are
+
+FlowField* flow_field_alloc(const bool* collision_map, uint16_t width, uint16_t height, TaskQueue* tasks);
+// A build can still be queued, so free it only after the task queue, or cancel the build first
+void flow_field_free(FlowField* field);
+
+// Move the target, a rebuild is queued only when it enters another cell
+void flow_field_target_set(FlowField* field, float x, float y);
+
+// Rebuild from the collision map as it is now, after terrain was carved or filled. The water
+// mask is rescanned right away, the field itself is rebuilt whole, there is no local repair
+void flow_field_invalidate(FlowField* field);
+
+// Unit step toward the target from a map position, false at the target or where it cannot be reached
+bool flow_field_direction_get(const FlowField* field, float x, float y, Vector* direction);
@@ -1,8 +1,40 @@
 #include "game.h"
+#include "engine/entity_registry.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define TAG "HunterKiller"
+
+// Sonar rays cast per ping step, about one every 0.1 radians
+#define PING_RAYS 63
+#define PING_RAYS_MIN 21
+#define TERRAIN_SAMPLE_RADIUS 80
+#define TERRAIN_SAMPLE_RADIUS_MIN 32
+#define PING_STEP_MS 50
+#define BACK_LONG_PRESS_MS 1000
+
+// Tilt steering: roll turns, pitch picks the throttle tier
+#define TILT_IMU_RATE_HZ 200
+#define TILT_IMU_LATENCY_MS 10 // FIFO latency, well under a frame so every frame sees fresh samples
+#define TILT_SETTLE_GYRO 0.1f // rad/s, ~6 dps, slower rotation counts as holding still
+#define TILT_SETTLE_MS 500 // still this long before the neutral pose is taken, the filter settles meanwhile
+#define TILT_DISPLAY_LEAD_MS 16 // from frame start to the frame being on screen
+#define TILT_LATENCY_LOG_FRAMES 30 // frames per logged motion to display latency
+#define IMU_RECORD_PATH APP_DATA_PATH("imu_record.bin") // raw FIFO stream, with the Debug setting on
+#define TILT_TURN_DEADZONE 5.0f // degrees
+#define TILT_TURN_FULL 30.0f // degrees for 1.5x the button turn rate
+#define TILT_TURN_GAIN 1.5f
+#define TILT_THROTTLE_STEP 10.0f // degrees of pitch per throttle tier
+#define TILT_TIER_HOLD -1
+
+static const float velocity_tiers[] = {0.0f, 0.033f, 0.066f, 0.1f};
+
+typedef enum {
+    GameEventBackLongPress = 1,
+    GameEventGesture = 2, // value is the ImuGestureType
+} GameEvent;
+
 // Forward declarations
 static const EntityDescription submarine_desc;
 static const EntityDescription torpedo_desc;
@@ -32,8 +64,8 @@ static ScreenPoint world_to_screen(GameContext* ctx, float world_x, float world_
     float rel_y = world_y - ctx->world_y;
     
     // Rotate around submarine (submarine always points "up" on screen)
-    float cos_h = cosf(-ctx->heading * 2 * 3.14159f);  // Negative for counter-rotation
-    float sin_h = sinf(-ctx->heading * 2 * 3.14159f);
+    float cos_h = fixed_cosf(-ctx->heading);  // Negative for counter-rotation
+    float sin_h = fixed_sinf(-ctx->heading);
     
     float rot_x = rel_x * cos_h - rel_y * sin_h;
     float rot_y = rel_x * sin_h + rel_y * cos_h;
@@ -53,8 +85,8 @@ __attribute__((unused)) static void screen_to_world(GameContext* ctx, float scre
     float rel_y = screen_y - ctx->screen_y;
     
     // Rotate to world coordinates
-    float cos_h = cosf(ctx->heading * 2 * 3.14159f);
-    float sin_h = sinf(ctx->heading * 2 * 3.14159f);
+    float cos_h = fixed_cosf(ctx->heading);
+    float sin_h = fixed_sinf(ctx->heading);
     
     float rot_x = rel_x * cos_h - rel_y * sin_h;
     float rot_y = rel_x * sin_h + rel_y * cos_h;
@@ -66,28 +98,19 @@ __attribute__((unused)) static void screen_to_world(GameContext* ctx, float scre
 
 /****** Input Handling ******/
 
-static void handle_input(GameManager* manager, GameContext* game_context) {
+static void handle_input(Entity* self, GameManager* manager, GameContext* game_context) {
     InputState input = game_manager_input_get(manager);
-    uint32_t current_time = furi_get_tick();
+    Level* level = game_manager_current_level_get(manager);
     
-    // Handle back button long/short press
+    // Handle back button long/short press, the long press fires GameEventBackLongPress
     if(input.pressed & GameKeyBack) {
-        game_context->back_press_start = current_time;
+        game_context->back_press_timer =
+            level_timer_start(level, self, GameEventBackLongPress, BACK_LONG_PRESS_MS, 0);
         game_context->back_long_press = false;
     }
     
-    if(input.held & GameKeyBack) {
-        if(current_time - game_context->back_press_start > 1000) { // 1 second for long press
-            if(!game_context->back_long_press) {
-                // Long press detected - exit game
-                game_manager_game_stop(manager);
-                return;
-            }
-        }
-    }
-    
     if(input.released & GameKeyBack) {
-        if(current_time - game_context->back_press_start < 1000) {
+        if(level_timer_stop(level, game_context->back_press_timer)) {
             // Short press - toggle mode
             game_context->mode = (game_context->mode == GAME_MODE_NAV) ? 
                                  GAME_MODE_TORPEDO : GAME_MODE_NAV;
@@ -116,15 +139,202 @@ static void submarine_start(Entity* self, GameManager* manager, void* context) {
     sub_context->game_context = game_manager_game_context_get(manager);
 }
 
+static void submarine_ping_step(GameContext* game_context) {
+    game_context->ping_radius += 2;
+    
+    // Perform raycasting to detect terrain
+    if(game_context->terrain && game_context->sonar_chart) {
+        int rays = quality_governor_knob_get(game_context->quality, game_context->ping_rays_knob);
+        float ray_step = 1.0f / rays;
+        for(int ray = 0; ray < rays; ray++) {
+            float angle = ray * ray_step; // in turns
+            int ray_x = (int)(game_context->ping_x + fixed_cosf(angle) * game_context->ping_radius);
+            int ray_y = (int)(game_context->ping_y + fixed_sinf(angle) * game_context->ping_radius);
+            
+            if(ray_x >= 0 && ray_x < game_context->chart_width && 
+               ray_y >= 0 && ray_y < game_context->chart_height) {
+                
+                // Mark as discovered in sonar chart
+                int chart_idx = ray_y * game_context->chart_width + ray_x;
+                game_context->sonar_chart[chart_idx] = true;
+            }
+        }
+    }
+}
+
+static void submarine_ping_script(Coroutine* co, Entity* self, GameManager* manager, void* context) {
+    UNUSED(self);
+    UNUSED(manager);
+    SubmarineContext* sub_context = context;
+    GameContext* game_context = sub_context->game_context;
+    
+    COROUTINE_BEGIN(co);
+    while(game_context->ping_radius <= 40) { // Max ping radius (reduced for screen size)
+        COROUTINE_WAIT_MS(co, PING_STEP_MS);
+        submarine_ping_step(game_context);
+    }
+    game_context->ping_active = false;
+    COROUTINE_END(co);
+}
+
+static void submarine_ping_start(Entity* self, GameManager* manager, GameContext* game_context) {
+    if(game_context->ping_active) return;
+    game_context->ping_active = true;
+    game_context->ping_x = game_context->world_x;
+    game_context->ping_y = game_context->world_y;
+    game_context->ping_radius = 0;
+    level_coroutine_start(game_manager_current_level_get(manager), self, submarine_ping_script);
+}
+
+static void submarine_torpedo_fire(GameManager* manager, GameContext* game_context) {
+    if(game_context->torpedo_count >= game_context->max_torpedoes) return;
+    Entity* torpedo = level_add_entity(game_manager_current_level_get(manager), &torpedo_desc);
+    if(torpedo) {
+        // Set torpedo initial world position and screen position
+        entity_pos_set(torpedo, (Vector){game_context->screen_x, game_context->screen_y});
+        game_context->torpedo_count++;
+    }
+}
+
+// OK button action: ping in navigation mode, torpedo in torpedo mode
+static void submarine_fire(Entity* self, GameManager* manager, GameContext* game_context) {
+    if(game_context->mode == GAME_MODE_NAV) {
+        submarine_ping_start(self, manager, game_context);
+    } else {
+        submarine_torpedo_fire(manager, game_context);
+    }
+}
+
+// Runs the gesture detector over every sample since the last frame, gestures go out as events
+static void submarine_gestures_poll(Entity* self, GameManager* manager, GameContext* game_context) {
+    Level* level = game_manager_current_level_get(manager);
+    ImuSample sample;
+    while(imu_sample_pop(game_context->imu, &sample)) {
+        ImuGestureType gesture = imu_gesture_feed(game_context->gesture, &sample);
+        if(gesture != ImuGestureNone) {
+            level_post_event(level, self, GameEventGesture, (EntityEventValue){.value = gesture});
+        }
+    }
+}
+
+// Turns tilt steering on or off, turning it on takes a new neutral pose
+static void submarine_tilt_enable(GameContext* game_context, bool enabled) {
+    game_context->tilt_control = enabled;
+    game_context->tilt_neutral_set = false;
+    game_context->tilt_still_since = furi_get_tick();
+    game_context->tilt_throttle_tier = TILT_TIER_HOLD;
+}
+
+// Waits for the device to be held still long enough for the filter to settle, the first
+// readings are still converging from the start pose and would make a skewed neutral
+static bool submarine_tilt_settled(GameContext* game_context) {
+    ImuOrientation orientation;
+    imu_orientation_get(game_context->imu, &orientation);
+    if(orientation.generation == game_context->tilt_generation) {
+        return false;
+    }
+    game_context->tilt_generation = orientation.generation;
+    
+    uint32_t now = furi_get_tick();
+    float rotation_sq = orientation.gx * orientation.gx + orientation.gy * orientation.gy +
+                        orientation.gz * orientation.gz;
+    if(rotation_sq > TILT_SETTLE_GYRO * TILT_SETTLE_GYRO) {
+        game_context->tilt_still_since = now;
+        return false;
+    }
+    return now - game_context->tilt_still_since >= TILT_SETTLE_MS;
+}
+
+static void submarine_tilt_steer(GameContext* game_context, InputState input) {
+    // Tilt does nothing until there is a neutral pose
+    if(!game_context->tilt_neutral_set && !submarine_tilt_settled(game_context)) {
+        return;
+    }
+    
+    // Predicted to when this frame reaches the screen, hides filter, FIFO and frame latency
+    ImuEuler tilt;
+    game_context->tilt_sample_tick =
+        imu_euler_predict(game_context->imu, TILT_DISPLAY_LEAD_MS, &tilt);
+    
+    if(!game_context->tilt_neutral_set) {
+        game_context->tilt_neutral_roll = tilt.roll;
+        game_context->tilt_neutral_pitch = tilt.pitch;
+        game_context->tilt_neutral_set = true;
+    }
+    float roll = tilt.roll - game_context->tilt_neutral_roll;
+    float pitch = tilt.pitch - game_context->tilt_neutral_pitch;
+    
+    // Turn rate follows roll, unless a turn button is held
+    if(!(input.held & (GameKeyUp | GameKeyDown)) && fabsf(roll) > TILT_TURN_DEADZONE) {
+        float amount = (fabsf(roll) - TILT_TURN_DEADZONE) / (TILT_TURN_FULL - TILT_TURN_DEADZONE);
+        if(amount > 1.0f) amount = 1.0f;
+        float turn = game_context->turn_rate * TILT_TURN_GAIN * amount;
+        game_context->heading += roll > 0 ? turn : -turn;
+        if(game_context->heading >= 1.0f) game_context->heading -= 1.0f;
+        if(game_context->heading < 0) game_context->heading += 1.0f;
+    }
+    
+    // Throttle tier changes only when the tilt enters a new tier, so buttons can still override
+    int8_t tier = TILT_TIER_HOLD;
+    if(pitch >= TILT_THROTTLE_STEP) {
+        tier = (int8_t)(pitch / TILT_THROTTLE_STEP);
+        if(tier > 3) tier = 3;
+    } else if(pitch <= -TILT_THROTTLE_STEP) {
+        tier = 0;
+    }
+    if(tier != TILT_TIER_HOLD && tier != game_context->tilt_throttle_tier) {
+        game_context->velocity = velocity_tiers[tier];
+    }
+    game_context->tilt_throttle_tier = tier;
+}
+
+// Time from the IMU sample to the commit of the frame steered by it, what the prediction hides
+static void submarine_tilt_latency(GameContext* game_context, GameEngine* engine) {
+    uint32_t sample_tick = game_context->tilt_latency_sample;
+    game_context->tilt_latency_sample = game_context->tilt_sample_tick;
+    if(!game_engine_show_fps_get(engine) || sample_tick == 0) return;
+
+    // this runs a frame later, the commit tick is the one of the frame the sample steered
+    uint32_t latency = game_engine_commit_tick_get(engine) - sample_tick;
+    game_context->tilt_latency_sum += latency;
+    game_context->tilt_latency_max = MAX(game_context->tilt_latency_max, latency);
+    if(++game_context->tilt_latency_frames == TILT_LATENCY_LOG_FRAMES) {
+        FURI_LOG_I(
+            TAG,
+            "Tilt sample to display: avg %lu ms, max %lu ms, predicted %u ms",
+            game_context->tilt_latency_sum / TILT_LATENCY_LOG_FRAMES,
+            game_context->tilt_latency_max,
+            TILT_DISPLAY_LEAD_MS);
+        game_context->tilt_latency_sum = 0;
+        game_context->tilt_latency_max = 0;
+        game_context->tilt_latency_frames = 0;
+    }
+}
+
 static void submarine_update(Entity* self, GameManager* manager, void* context) {
     SubmarineContext* sub_context = context;
     GameContext* game_context = sub_context->game_context;
     
     // Handle input first
-    handle_input(manager, game_context);
+    handle_input(self, manager, game_context);
     
     InputState input = game_manager_input_get(manager);
     
+    // Hunters chase the submarine, the field only rebuilds when it crosses a cell
+    if(game_context->flow_field) {
+        flow_field_target_set(game_context->flow_field, game_context->world_x, game_context->world_y);
+    }
+    
+    // Tilt is sampled at frame start, buttons below apply on top of it
+    if(game_context->tilt_available) {
+        submarine_gestures_poll(self, manager, game_context);
+    }
+    game_context->tilt_sample_tick = 0;
+    if(game_context->tilt_control) {
+        submarine_tilt_steer(game_context, input);
+    }
+    submarine_tilt_latency(game_context, game_manager_engine_get(manager));
+    
     // Handle movement controls (rotated 90° CCW for portrait mode)
     // Physical UP -> turn right, DOWN -> turn left, LEFT -> accelerate, RIGHT -> decelerate
     if(input.held & GameKeyUp) {    // Physical up = turn right
@@ -158,63 +368,14 @@ static void submarine_update(Entity* self, GameManager* manager, void* context)
     
     // Handle OK button (ping or fire)
     if(input.pressed & GameKeyOk) {
-        if(game_context->mode == GAME_MODE_NAV) {
-            // Start ping
-            if(!game_context->ping_active) {
-                game_context->ping_active = true;
-                game_context->ping_x = game_context->world_x;
-                game_context->ping_y = game_context->world_y;
-                game_context->ping_radius = 0;
-                game_context->ping_timer = furi_get_tick();
-            }
-        } else {
-            // Fire torpedo
-            if(game_context->torpedo_count < game_context->max_torpedoes) {
-                Level* current_level = game_manager_current_level_get(manager);
-                Entity* torpedo = level_add_entity(current_level, &torpedo_desc);
-                if(torpedo) {
-                    // Set torpedo initial world position and screen position
-                    entity_pos_set(torpedo, (Vector){game_context->screen_x, game_context->screen_y});
-                    game_context->torpedo_count++;
-                }
-            }
-        }
-    }
-    
-    // Update ping with terrain detection
-    if(game_context->ping_active) {
-        uint32_t current_time = furi_get_tick();
-        if(current_time - game_context->ping_timer > 50) { // Update every 50ms
-            game_context->ping_radius += 2;
-            game_context->ping_timer = current_time;
-            
-            // Perform raycasting to detect terrain
-            if(game_context->terrain && game_context->sonar_chart) {
-                for(float angle = 0; angle < 2 * 3.14159f; angle += 0.1f) {
-                    int ray_x = (int)(game_context->ping_x + cosf(angle) * game_context->ping_radius);
-                    int ray_y = (int)(game_context->ping_y + sinf(angle) * game_context->ping_radius);
-                    
-                    if(ray_x >= 0 && ray_x < game_context->chart_width && 
-                       ray_y >= 0 && ray_y < game_context->chart_height) {
-                        
-                        // Mark as discovered in sonar chart
-                        int chart_idx = ray_y * game_context->chart_width + ray_x;
-                        game_context->sonar_chart[chart_idx] = true;
-                    }
-                }
-            }
-            
-            if(game_context->ping_radius > 40) { // Max ping radius (reduced for screen size)
-                game_context->ping_active = false;
-            }
-        }
+        submarine_fire(self, manager, game_context);
     }
     
     // Update submarine world position
     // Adjust heading so 0 = forward (negative Y), matching screen orientation
-    float movement_heading = (game_context->heading - 0.25f) * 2 * 3.14159f;
-    float dx = game_context->velocity * cosf(movement_heading);
-    float dy = game_context->velocity * sinf(movement_heading);
+    float movement_heading = game_context->heading - 0.25f;
+    float dx = game_context->velocity * fixed_cosf(movement_heading);
+    float dy = game_context->velocity * fixed_sinf(movement_heading);
     
     float new_world_x = game_context->world_x + dx;
     float new_world_y = game_context->world_y + dy;
@@ -233,6 +394,32 @@ static void submarine_update(Entity* self, GameManager* manager, void* context)
     entity_pos_set(self, (Vector){game_context->screen_x, game_context->screen_y});
 }
 
+static void submarine_event(Entity* self, GameManager* manager, EntityEvent event, void* context) {
+    UNUSED(self);
+    SubmarineContext* sub_context = context;
+    GameContext* game_context = sub_context->game_context;
+    
+    switch(event.type) {
+    case GameEventBackLongPress:
+        // Long press detected - exit game
+        game_context->back_long_press = true;
+        game_manager_game_stop(manager);
+        break;
+    case GameEventGesture:
+        // A flick does what OK does, a tap always pings, a shake switches tilt steering
+        if(event.value.value == ImuGestureFlick) {
+            submarine_fire(self, manager, game_context);
+        } else if(event.value.value == ImuGestureTap) {
+            submarine_ping_start(self, manager, game_context);
+        } else if(event.value.value == ImuGestureShake) {
+            submarine_tilt_enable(game_context, !game_context->tilt_control);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 static void submarine_render(Entity* self, GameManager* manager, Canvas* canvas, void* context) {
     UNUSED(self);
     UNUSED(manager);
@@ -242,7 +429,9 @@ static void submarine_render(Entity* self, GameManager* manager, Canvas* canvas,
     // Draw terrain - transform world coordinates to screen
     if(game_context->terrain && game_context->sonar_chart) {
         // Sample terrain around submarine's world position
-        int sample_radius = 80; // How far to sample around submarine
+        // How far to sample around submarine
+        int sample_radius =
+            quality_governor_knob_get(game_context->quality, game_context->terrain_radius_knob);
         
         for(int world_y = (int)game_context->world_y - sample_radius; 
             world_y <= (int)game_context->world_y + sample_radius; world_y++) {
@@ -324,6 +513,20 @@ static void submarine_render(Entity* self, GameManager* manager, Canvas* canvas,
         canvas_draw_frame(canvas, box_screen.screen_x, box_screen.screen_y, 16, 12);
     }
     
+    // Draw tilt steering indicator, hollow until the device was held still for a neutral pose
+    if(game_context->tilt_control) {
+        ScreenPoint tilt_screen = portrait_to_screen(26, 119);
+        if(game_context->tilt_neutral_set) {
+            canvas_draw_disc(canvas, tilt_screen.screen_x, tilt_screen.screen_y, 2);
+        } else {
+            canvas_draw_circle(canvas, tilt_screen.screen_x, tilt_screen.screen_y, 2);
+        }
+    }
+    if(game_context->imu_recording) {
+        ScreenPoint record_screen = portrait_to_screen(26, 125);
+        canvas_draw_dot(canvas, record_screen.screen_x, record_screen.screen_y);
+    }
+    
     // Draw torpedo indicators (bottom right in portrait)
     for(int i = 0; i < game_context->max_torpedoes; i++) {
         int torp_portrait_x = 40 + (i % 4) * 6;  // 4 columns
@@ -359,7 +562,7 @@ static const EntityDescription submarine_desc = {
     .update = submarine_update,
     .render = submarine_render,
     .collision = NULL,
-    .event = NULL,
+    .event = submarine_event,
     .context_size = sizeof(SubmarineContext),
 };
 
@@ -395,9 +598,9 @@ static void torpedo_update(Entity* self, GameManager* manager, void* context) {
     
     // Move torpedo in world coordinates
     // Use same heading adjustment as submarine movement
-    float movement_heading = (torp_context->heading - 0.25f) * 2 * 3.14159f;
-    float dx = torp_context->speed * cosf(movement_heading);
-    float dy = torp_context->speed * sinf(movement_heading);
+    float movement_heading = torp_context->heading - 0.25f;
+    float dx = torp_context->speed * fixed_cosf(movement_heading);
+    float dy = torp_context->speed * fixed_sinf(movement_heading);
     
     torp_context->world_x += dx;
     torp_context->world_y += dy;
@@ -460,14 +663,139 @@ static const EntityDescription torpedo_desc = {
     .context_size = sizeof(TorpedoContext),
 };
 
+/****** Entities: Hunter ******/
+
+#define HUNTER_COUNT 3
+#define HUNTER_SPEED 1.2f // units per second, below the submarine's top speed so it can get away
+#define HUNTER_SPAWN_DISTANCE 40 // spawn at least this far from the submarine
+#define HUNTER_SPAWN_TRIES 32
+#define HUNTER_CLOSE 4 // holds position this close to the submarine
+
+typedef struct {
+    float world_x;
+    float world_y;
+    GameContext* game_context;
+} HunterContext;
+
+static void hunter_start(Entity* self, GameManager* manager, void* context) {
+    HunterContext* hunter = context;
+    GameContext* game_context = game_manager_game_context_get(manager);
+    hunter->game_context = game_context;
+    
+    // Spawn in open water away from the submarine, the last try is kept if none fits
+    Rng* rng = level_rng_get(game_manager_current_level_get(manager));
+    float width = game_context->terrain ? game_context->terrain->width : game_context->chart_width;
+    float height = game_context->terrain ? game_context->terrain->height : game_context->chart_height;
+    for(int i = 0; i < HUNTER_SPAWN_TRIES; i++) {
+        hunter->world_x = rng_range_float(rng, 0, width);
+        hunter->world_y = rng_range_float(rng, 0, height);
+        
+        float dx = hunter->world_x - game_context->world_x;
+        float dy = hunter->world_y - game_context->world_y;
+        bool in_water = !game_context->terrain ||
+                        !terrain_check_collision(game_context->terrain, (int)hunter->world_x, (int)hunter->world_y);
+        if(in_water && dx * dx + dy * dy >= HUNTER_SPAWN_DISTANCE * HUNTER_SPAWN_DISTANCE) break;
+    }
+    
+    // Add collision detection
+    entity_collider_add_circle(self, 2);
+}
+
+static void hunter_update(Entity* self, GameManager* manager, void* context) {
+    UNUSED(manager);
+    HunterContext* hunter = context;
+    GameContext* game_context = hunter->game_context;
+    
+    float dx = game_context->world_x - hunter->world_x;
+    float dy = game_context->world_y - hunter->world_y;
+    float distance_squared = dx * dx + dy * dy;
+    
+    // Steering is the level of detail step, far hunters run it a few times a second
+    if(entity_update_due(self) && distance_squared > HUNTER_CLOSE * HUNTER_CLOSE) {
+        // One lookup in the shared flow field, whatever the number of hunters
+        Vector step;
+        if(!game_context->flow_field ||
+           !flow_field_direction_get(game_context->flow_field, hunter->world_x, hunter->world_y, &step)) {
+            // In the submarine's cell, or before the first field is built: head straight for it
+            float distance = sqrtf(distance_squared);
+            step = (Vector){dx / distance, dy / distance};
+        }
+        
+        // Far hunters steer a few times a second, move them for all the time since the last one
+        float distance_step = HUNTER_SPEED * entity_update_delta_get(self);
+        float new_world_x = hunter->world_x + step.x * distance_step;
+        float new_world_y = hunter->world_y + step.y * distance_step;
+        if(!game_context->terrain ||
+           !terrain_check_collision(game_context->terrain, (int)new_world_x, (int)new_world_y)) {
+            hunter->world_x = new_world_x;
+            hunter->world_y = new_world_y;
+        }
+    }
+    
+    // Transform hunter world position to screen position, every frame as the submarine moves
+    ScreenPoint screen = world_to_screen(game_context, hunter->world_x, hunter->world_y);
+    entity_pos_set(self, (Vector){screen.screen_x, screen.screen_y});
+}
+
+static void hunter_render(Entity* self, GameManager* manager, Canvas* canvas, void* context) {
+    UNUSED(manager);
+    UNUSED(context);
+    Vector pos = entity_pos_get(self);
+    
+    // Only draw if on screen (landscape screen)
+    if(pos.x >= 0 && pos.x < 128 && pos.y >= 0 && pos.y < 64) {
+        canvas_draw_circle(canvas, pos.x, pos.y, 2);
+    }
+}
+
+static void hunter_collision(Entity* self, Entity* other, GameManager* manager, void* context) {
+    UNUSED(context);
+    
+    // A torpedo sinks the hunter, torpedo_stop gives the torpedo back
+    if(entity_description_get(other) == &torpedo_desc) {
+        Level* current_level = game_manager_current_level_get(manager);
+        level_remove_entity(current_level, other);
+        level_remove_entity(current_level, self);
+    }
+}
+
+static const EntityDescription hunter_desc = {
+    .start = hunter_start,
+    .stop = NULL,
+    .update = hunter_update,
+    .render = hunter_render,
+    .collision = hunter_collision,
+    .event = NULL,
+    .context_size = sizeof(HunterContext),
+    .update_lod = true,
+};
+
+/****** Entity registry ******/
+
+#define GAME_ENTITIES(X) \
+    X(submarine_desc)    \
+    X(torpedo_desc)      \
+    X(hunter_desc)
+
+ENTITY_REGISTRY_DEFINE(game_entities, GAME_ENTITIES)
+
 /****** Level ******/
 
 static void level_alloc(Level* level, GameManager* manager, void* context) {
     UNUSED(context);
     UNUSED(manager);
     
-    // Add submarine entity to the level
-    level_add_entity(level, &submarine_desc);
+    // Add submarine entity to the level, the level is not current yet so it subscribes here
+    Entity* submarine = level_add_entity(level, &submarine_desc);
+    level_subscribe_event(level, submarine, GameEventGesture);
+    
+    // Hunters far from the submarine update less often
+    level_update_focus_set(level, submarine);
+    
+    // And the hunters chasing it
+    for(int i = 0; i < HUNTER_COUNT; i++) {
+        level_add_entity(level, &hunter_desc);
+    }
 }
 
 static const LevelBehaviour level = {
@@ -483,8 +811,28 @@ static const LevelBehaviour level = {
 static void game_start(GameManager* game_manager, void* ctx) {
     GameContext* game_context = ctx;
     
-    // Initialize terrain system first
-    game_context->terrain = terrain_manager_alloc(12345, 0.5f); // seed=12345, elevation=0.5
+    // Register quality knobs, the first one added is the first turned down
+    game_context->quality = game_engine_quality_get(game_manager_engine_get(game_manager));
+    game_context->terrain_radius_knob = quality_governor_knob_add(
+        game_context->quality, "terrain radius", TERRAIN_SAMPLE_RADIUS, TERRAIN_SAMPLE_RADIUS_MIN, 16);
+    game_context->ping_rays_knob = quality_governor_knob_add(
+        game_context->quality, "ping rays", PING_RAYS, PING_RAYS_MIN, 14);
+    
+    // Initialize terrain system
+    Arena* scratch = game_engine_startup_scratch_get(game_manager_engine_get(game_manager));
+    JobSystem* jobs = game_manager_jobs_get(game_manager);
+    game_context->terrain =
+        terrain_manager_alloc(12345, 0.5f, scratch, jobs); // seed=12345, elevation=0.5
+    
+    // Flow field for the hunters, built on the engine task queue between frames
+    game_context->flow_field = NULL;
+    if(game_context->terrain) {
+        game_context->flow_field = flow_field_alloc(
+            game_context->terrain->collision_map,
+            game_context->terrain->width,
+            game_context->terrain->height,
+            game_engine_task_queue_get(game_manager_engine_get(game_manager)));
+    }
     
     // Initialize sonar chart (same size as screen)
     game_context->chart_width = 128;
@@ -527,9 +875,9 @@ static void game_start(GameManager* game_manager, void* ctx) {
         if(!found_water) {
             for(int radius = 10; radius <= 50 && !found_water; radius += 5) {
                 for(int angle = 0; angle < 36 && !found_water; angle++) {
-                    float test_angle = angle * (2.0f * 3.14159f / 36.0f);
-                    int test_x = (int)(game_context->world_x + cosf(test_angle) * radius);
-                    int test_y = (int)(game_context->world_y + sinf(test_angle) * radius);
+                    float test_angle = angle * (1.0f / 36.0f); // in turns
+                    int test_x = (int)(game_context->world_x + fixed_cosf(test_angle) * radius);
+                    int test_y = (int)(game_context->world_y + fixed_sinf(test_angle) * radius);
                     
                     // Keep within terrain bounds with bigger margin
                     if(test_x >= 15 && test_x < game_context->chart_width - 15 &&
@@ -570,7 +918,24 @@ static void game_start(GameManager* game_manager, void* ctx) {
     game_context->ping_active = false;
     game_context->ping_radius = 0;
     
-    game_context->back_press_start = 0;
+    // Tilt steering when the IMU module is plugged in, on at start, a shake switches it
+    game_context->imu = imu_alloc();
+    game_context->tilt_available = imu_present(game_context->imu);
+    game_context->tilt_generation = 0;
+    submarine_tilt_enable(game_context, game_context->tilt_available);
+    game_context->gesture = imu_gesture_alloc();
+    if(game_context->tilt_available) {
+        imu_rate_set(game_context->imu, TILT_IMU_RATE_HZ);
+        imu_latency_set(game_context->imu, TILT_IMU_LATENCY_MS);
+        imu_samples_enable(game_context->imu, true);
+    }
+    
+    // With the system Debug setting on the raw sensor stream goes to SD, for host replay and benchmarks
+    game_context->imu_recording = game_context->tilt_available &&
+                                  furi_hal_rtc_is_flag_set(FuriHalRtcFlagDebug) &&
+                                  imu_record_start(game_context->imu, IMU_RECORD_PATH);
+    
+    game_context->back_press_timer = TIMER_ID_NONE;
     game_context->back_long_press = false;
     
     // Game settings
@@ -585,11 +950,22 @@ static void game_start(GameManager* game_manager, void* ctx) {
 static void game_stop(void* ctx) {
     GameContext* game_context = ctx;
     
+    // Clean up hunter navigation before the terrain it reads, the engine task queue is gone by now
+    if(game_context->flow_field) {
+        flow_field_free(game_context->flow_field);
+    }
+    
     // Clean up terrain system
     if(game_context->terrain) {
         terrain_manager_free(game_context->terrain);
     }
     
+    if(game_context->imu_recording) {
+        imu_record_stop(game_context->imu);
+    }
+    imu_free(game_context->imu);
+    imu_gesture_free(game_context->gesture);
+    
     // Clean up sonar chart
     if(game_context->sonar_chart) {
         free(game_context->sonar_chart);
@@ -603,4 +979,5 @@ const Game game = {
     .start = game_start,
     .stop = game_stop,
     .context_size = sizeof(GameContext),
+    .entity_registry = &game_entities,
 };
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 #include "engine/engine.h"
 #include "terrain.h"
+#include "flow_field.h"
+#include "engine/sensors/imu.h"
+#include "engine/sensors/imu_gesture.h"
 
 typedef enum {
     GAME_MODE_NAV,
@@ -28,10 +31,9 @@ typedef struct {
     float ping_x;
     float ping_y;
     uint8_t ping_radius;
-    uint32_t ping_timer;
     
     // Input state
-    uint32_t back_press_start;
+    TimerId back_press_timer;
     bool back_long_press;
     
     // Game settings
@@ -42,8 +44,34 @@ typedef struct {
     // Terrain system
     TerrainManager* terrain;
     
+    // Hunter navigation, points every water cell toward the submarine
+    FlowField* flow_field;
+    
     // Sonar chart for discovered areas
     bool* sonar_chart;
     uint16_t chart_width;
     uint16_t chart_height;
+    
+    // Tilt steering, on when the IMU module is present, buttons override it
+    Imu* imu;
+    bool tilt_available; // IMU module present
+    bool tilt_control; // switched by shaking
+    bool imu_recording; // raw IMU stream to SD, on with the system Debug setting
+    bool tilt_neutral_set;
+    uint32_t tilt_still_since; // tick the device was last seen rotating
+    uint32_t tilt_generation; // last orientation looked at while settling
+    float tilt_neutral_roll;
+    float tilt_neutral_pitch;
+    int8_t tilt_throttle_tier;
+    uint32_t tilt_sample_tick; // IMU sample behind this frame's tilt, 0 if tilt did not steer
+    uint32_t tilt_latency_sample; // the same for the previous frame
+    uint32_t tilt_latency_sum; // sample to display, in ms, logged under show_fps
+    uint32_t tilt_latency_max;
+    uint16_t tilt_latency_frames;
+    ImuGesture* gesture;
+    
+    // Quality knobs, turned down by the engine when frames run long
+    QualityGovernor* quality;
+    QualityKnob terrain_radius_knob;
+    QualityKnob ping_rays_knob;
 } GameContext;
\ No newline at end of file
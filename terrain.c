@@ -7,23 +7,15 @@
 #define MAX_DELTA 0.3f
 #define ROUGHNESS_DECAY 2.0f
 
-// Random number generation with seed
-static uint32_t terrain_seed = 12345;
-
-static void terrain_srand(uint32_t seed) {
-    terrain_seed = seed;
-}
-
-static float terrain_rand(void) {
-    terrain_seed = terrain_seed * 1103515245 + 12345;
-    return ((terrain_seed >> 16) & 0x7fff) / (float)0x7fff;
-}
-
-static float terrain_rand_range(float range) {
-    return terrain_rand() * range - (range / 2.0f);
+static float terrain_rand_range(TerrainManager* terrain, float range) {
+    return rng_range_float(&terrain->rng, -range / 2.0f, range / 2.0f);
 }
 
-TerrainManager* terrain_manager_alloc(uint32_t seed, float elevation) {
+TerrainManager* terrain_manager_alloc(
+    uint32_t seed,
+    float elevation,
+    Arena* scratch,
+    JobSystem* jobs) {
     TerrainManager* terrain = malloc(sizeof(TerrainManager));
     if(!terrain) return NULL;
     
@@ -44,7 +36,7 @@ TerrainManager* terrain_manager_alloc(uint32_t seed, float elevation) {
     
     // Generate terrain
     terrain_generate_diamond_square(terrain);
-    terrain_apply_elevation_threshold(terrain);
+    terrain_apply_elevation_threshold(terrain, scratch, jobs);
     
     return terrain;
 }
@@ -73,7 +65,7 @@ static void terrain_set_height(TerrainManager* terrain, int x, int y, float heig
 
 static void terrain_init_corners(TerrainManager* terrain) {
     int step = TERRAIN_SIZE - 1;
-    terrain_srand(terrain->seed);
+    rng_seed(&terrain->rng, terrain->seed);
     
     // Initialize corner values for each chunk
     for(int chunk_x = 0; chunk_x < TERRAIN_CHUNKS; chunk_x++) {
@@ -81,8 +73,8 @@ static void terrain_init_corners(TerrainManager* terrain) {
             int base_x = chunk_x * step;
             int base_y = chunk_y * step;
             
-            terrain_srand(terrain->seed + (base_x * base_y * 6));
-            terrain_set_height(terrain, base_x, base_y, terrain_rand());
+            rng_seed(&terrain->rng, terrain->seed + (base_x * base_y * 6));
+            terrain_set_height(terrain, base_x, base_y, rng_float(&terrain->rng));
         }
     }
 }
@@ -98,7 +90,7 @@ static void terrain_diamond_step(TerrainManager* terrain, int x, int y, int size
     
     // Calculate average and add random offset
     float avg = (tl + tr + bl + br) / 4.0f;
-    float offset = terrain_rand_range(roughness);
+    float offset = terrain_rand_range(terrain, roughness);
     
     terrain_set_height(terrain, x, y, avg + offset);
 }
@@ -128,7 +120,7 @@ static void terrain_square_step(TerrainManager* terrain, int x, int y, int size,
     
     if(count > 0) {
         float avg = total / count;
-        float offset = terrain_rand_range(roughness);
+        float offset = terrain_rand_range(terrain, roughness);
         terrain_set_height(terrain, x, y, avg + offset);
     }
 }
@@ -162,22 +154,28 @@ void terrain_generate_diamond_square(TerrainManager* terrain) {
     }
 }
 
-void terrain_apply_elevation_threshold(TerrainManager* terrain) {
-    for(int y = 0; y < terrain->height; y++) {
+typedef struct {
+    TerrainManager* terrain;
+    const bool* land_map;
+} TerrainThresholdJob;
+
+static void terrain_threshold_rows(size_t start, size_t end, void* context) {
+    TerrainThresholdJob* job = context;
+    TerrainManager* terrain = job->terrain;
+    for(int y = start; y < (int)end; y++) {
         for(int x = 0; x < terrain->width; x++) {
             int idx = y * terrain->width + x;
             float height = terrain->height_map[idx];
             terrain->collision_map[idx] = (height > terrain->elevation_threshold);
         }
     }
-    
-    // Apply despeckle filter - remove isolated land pixels
-    bool* temp_map = malloc(terrain->width * terrain->height * sizeof(bool));
-    if(!temp_map) return;
-    
-    memcpy(temp_map, terrain->collision_map, terrain->width * terrain->height * sizeof(bool));
-    
-    for(int y = 0; y < terrain->height; y++) {
+}
+
+static void terrain_despeckle_rows(size_t start, size_t end, void* context) {
+    TerrainThresholdJob* job = context;
+    TerrainManager* terrain = job->terrain;
+    const bool* temp_map = job->land_map;
+    for(int y = start; y < (int)end; y++) {
         for(int x = 0; x < terrain->width; x++) {
             int idx = y * terrain->width + x;
             if(temp_map[idx]) { // If this is land
@@ -208,8 +206,23 @@ void terrain_apply_elevation_threshold(TerrainManager* terrain) {
             }
         }
     }
+}
+
+void terrain_apply_elevation_threshold(TerrainManager* terrain, Arena* scratch, JobSystem* jobs) {
+    // rows are independent, so both passes are split across the job system
+    TerrainThresholdJob job = {.terrain = terrain, .land_map = NULL};
+    job_parallel_for(jobs, terrain->height, 0, terrain_threshold_rows, &job);
+    
+    // Apply despeckle filter - remove isolated land pixels
+    ArenaMark mark = arena_mark(scratch);
+    bool* temp_map = arena_push(scratch, terrain->width * terrain->height * sizeof(bool));
+    
+    memcpy(temp_map, terrain->collision_map, terrain->width * terrain->height * sizeof(bool));
+    
+    job.land_map = temp_map;
+    job_parallel_for(jobs, terrain->height, 0, terrain_despeckle_rows, &job);
     
-    free(temp_map);
+    arena_rewind(scratch, mark);
 }
 
 bool terrain_check_collision(TerrainManager* terrain, int x, int y) {
@@ -13,14 +13,19 @@ typedef struct {
     uint16_t height;
     float elevation_threshold;
     uint32_t seed;
+    Rng rng;
 } TerrainManager;
 
 // Terrain generation functions
-TerrainManager* terrain_manager_alloc(uint32_t seed, float elevation);
+TerrainManager* terrain_manager_alloc(
+    uint32_t seed,
+    float elevation,
+    Arena* scratch,
+    JobSystem* jobs);
 void terrain_manager_free(TerrainManager* terrain);
 bool terrain_check_collision(TerrainManager* terrain, int x, int y);
 void terrain_render_area(TerrainManager* terrain, Canvas* canvas, int start_x, int start_y, int end_x, int end_y);
 
 // Terrain generation utilities
 void terrain_generate_diamond_square(TerrainManager* terrain);
-void terrain_apply_elevation_threshold(TerrainManager* terrain);
\ No newline at end of file
+void terrain_apply_elevation_threshold(TerrainManager* terrain, Arena* scratch, JobSystem* jobs);
\ No newline at end of file
@@ -0,0 +1,150 @@
+// Host benchmark of the IMU filter path, run with `make bench` or `build/bench_imu [recording]`.
+// Recordings are raw FIFO packets from imu_record_start(), without one a synthetic stream is used.
+#include "sensors/imu.c"
+#include <time.h>
+
+#define BENCH_SYNTHETIC_PACKETS 20000 // 200 s at 100 Hz
+#define BENCH_PASSES 20
+#define BENCH_BATCH 4 // packets per FIFO read at the default rate and latency
+
+typedef enum {
+    BenchQuaternion, // what the sensor thread does now, publish the quaternion once per batch
+    BenchEulerEach, // plus the Euler conversion on every sample, as before the lazy conversion
+    BenchSamples, // quaternion path with the sample ring on and drained
+} BenchMode;
+
+static const char* const bench_mode_names[] = {
+    [BenchQuaternion] = "quaternion, publish per batch",
+    [BenchEulerEach] = "euler on every sample",
+    [BenchSamples] = "quaternion, sample ring on",
+};
+
+static ICM42688PFifoPacket* bench_load(const char* path, size_t* count) {
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    *count = size > 0 ? (size_t)size / sizeof(ICM42688PFifoPacket) : 0;
+    ICM42688PFifoPacket* packets = NULL;
+    if(*count > 0) {
+        packets = malloc(*count * sizeof(ICM42688PFifoPacket));
+        *count = fread(packets, sizeof(ICM42688PFifoPacket), *count, file);
+    } else {
+        fprintf(stderr, "no packets in %s\n", path);
+    }
+    fclose(file);
+    return packets;
+}
+
+// slow swings on every axis with the gravity vector following roll, 100 Hz timestamps
+static ICM42688PFifoPacket* bench_synthesize(size_t* count) {
+    *count = BENCH_SYNTHETIC_PACKETS;
+    ICM42688PFifoPacket* packets = malloc(*count * sizeof(ICM42688PFifoPacket));
+    for(size_t i = 0; i < *count; i++) {
+        float t = (float)i * 0.01f;
+        float roll = 0.6f * sinf(t * 1.3f);
+        packets[i] = (ICM42688PFifoPacket){
+            .header = 0x68,
+            .a_x = (int16_t)(2048.f * sinf(roll)),
+            .a_y = (int16_t)(300.f * sinf(t * 0.7f)),
+            .a_z = (int16_t)(2048.f * cosf(roll)),
+            .g_x = (int16_t)(2000.f * cosf(t * 1.3f)),
+            .g_y = (int16_t)(900.f * sinf(t * 0.9f)),
+            .g_z = (int16_t)(1500.f * sinf(t * 0.4f)),
+            .temp = 20,
+            .ts = (uint16_t)(i * 10000),
+        };
+    }
+    return packets;
+}
+
+static void bench_thread_reset(ImuThread* imu) {
+    memset(imu, 0, sizeof(ImuThread));
+    imu->gyro_rad_scale = 2000.f / 32768.f * M_PI / 180.f;
+    imu->accel_g_scale = 16.f / 32768.f;
+    imu->sample_dt = 0.01f;
+    imu->processed_data.q0 = 1.f;
+}
+
+static uint64_t bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+static double
+    bench_run(ImuThread* imu, const ICM42688PFifoPacket* packets, size_t count, BenchMode mode) {
+    ImuEuler euler = {0};
+    float sink = 0.f;
+
+    uint64_t start = bench_now_ns();
+    for(size_t pass = 0; pass < BENCH_PASSES; pass++) {
+        bench_thread_reset(imu);
+        atomic_store(&imu->samples.enabled, mode == BenchSamples);
+
+        for(size_t i = 0; i < count; i++) {
+            ICM42688PFifoPacket packet = packets[i];
+            imu_process_data(imu, &packet);
+
+            if(mode == BenchEulerEach) {
+                ImuOrientation orientation = {
+                    .q0 = imu->processed_data.q0,
+                    .q1 = imu->processed_data.q1,
+                    .q2 = imu->processed_data.q2,
+                    .q3 = imu->processed_data.q3,
+                };
+                imu_quaternion_to_euler(&orientation, false, &euler);
+                sink += euler.roll;
+            }
+
+            if(i % BENCH_BATCH == BENCH_BATCH - 1 || i == count - 1) {
+                imu_publish(imu, furi_get_tick());
+                if(mode == BenchSamples) {
+                    // the reader keeps up, so the ring never fills
+                    ImuSampleRing* ring = &imu->samples;
+                    atomic_store(&ring->head, atomic_load(&ring->tail));
+                }
+            }
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    // keep the results alive so nothing is optimised out
+    ImuOrientation last;
+    imu_seqlock_read(&imu->published, &last);
+    sink += last.q0 + last.q1 + last.q2 + last.q3;
+    if(isnan(sink)) printf("nan in the filter output\n");
+
+    return (double)elapsed / (double)(BENCH_PASSES * count);
+}
+
+int main(int argc, char** argv) {
+    size_t count;
+    ICM42688PFifoPacket* packets = argc > 1 ? bench_load(argv[1], &count) :
+                                              bench_synthesize(&count);
+    if(!packets) return 1;
+
+    const char* source = argc > 1 ? argv[1] : "synthetic motion";
+    printf("%zu packets from %s, %d passes\n", count, source, BENCH_PASSES);
+
+    ImuThread* imu = malloc(sizeof(ImuThread));
+    double per_sample[COUNT_OF(bench_mode_names)];
+    for(size_t mode = 0; mode < COUNT_OF(bench_mode_names); mode++) {
+        // a short run first to warm the caches
+        bench_run(imu, packets, MIN(count, (size_t)1000), mode);
+        per_sample[mode] = bench_run(imu, packets, count, mode);
+        printf("  %-32s %7.1f ns/sample\n", bench_mode_names[mode], per_sample[mode]);
+    }
+    printf(
+        "  lazy euler saves %.0f%% per sample\n",
+        100.0 * (1.0 - per_sample[BenchQuaternion] / per_sample[BenchEulerEach]));
+
+    free(imu);
+    free(packets);
+    return 0;
+}
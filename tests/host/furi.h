@@ -0,0 +1,86 @@
+#pragma once
+#include <assert.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Host stand-ins for the parts of furi the engine tests build against, see furi_host.c
+
+#define UNUSED(x) (void)(x)
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#define COUNT_OF(x) (sizeof(x) / sizeof((x)[0]))
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+void furi_log_print(char level, const char* tag, const char* format, ...)
+    __attribute__((__format__(__printf__, 3, 4)));
+
+#define FURI_LOG_E(tag, ...) furi_log_print('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) furi_log_print('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) furi_log_print('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) furi_log_print('D', tag, __VA_ARGS__)
+
+void furi_crash(const char* message) __attribute__((noreturn));
+
+#define furi_check(condition, ...) ((condition) ? (void)0 : furi_crash(#condition))
+#define furi_assert(condition, ...) furi_check(condition)
+
+// apps keep their data under the storage root, see furi_host_storage_root_set
+#define APP_DATA_PATH(path) "/ext/apps_data/host/" path
+
+typedef enum {
+    FuriFlagWaitAny = 0,
+    FuriFlagWaitAll = 1,
+    FuriFlagNoClear = 2,
+    FuriFlagError = (int)0x80000000,
+    FuriFlagErrorTimeout = (int)0xFFFFFFFE,
+} FuriFlag;
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef struct FuriThread FuriThread;
+typedef FuriThread* FuriThreadId;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+typedef enum {
+    FuriThreadStateStopped,
+    FuriThreadStateStarting,
+    FuriThreadStateRunning,
+} FuriThreadState;
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+FuriThreadState furi_thread_get_state(FuriThread* thread);
+FuriThreadId furi_thread_get_id(FuriThread* thread);
+FuriThreadId furi_thread_get_current_id(void);
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags);
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+// ticks are milliseconds
+uint32_t furi_get_tick(void);
+void furi_delay_tick(uint32_t ticks);
+void furi_delay_ms(uint32_t milliseconds);
+void furi_delay_us(uint32_t microseconds);
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+// Host only: directory that stands in for the SD card, "/ext" paths land under it
+void furi_host_storage_root_set(const char* root);
@@ -0,0 +1,56 @@
+#pragma once
+#include <furi.h>
+
+// Host stand-ins for the HAL parts the sensor drivers use. The SPI bus only exists in
+// spi_mock.c, tests that link the real ICM42688P driver link that too.
+
+typedef struct {
+    uint8_t port;
+} GpioPin;
+
+typedef enum {
+    GpioModeAnalog,
+    GpioModeInterruptRise,
+} GpioMode;
+
+typedef enum {
+    GpioPullNo,
+    GpioPullDown,
+} GpioPull;
+
+typedef enum {
+    GpioSpeedLow,
+    GpioSpeedVeryHigh,
+} GpioSpeed;
+
+typedef void (*GpioExtiCallback)(void* context);
+
+void furi_hal_gpio_init(const GpioPin* pin, GpioMode mode, GpioPull pull, GpioSpeed speed);
+void furi_hal_gpio_add_int_callback(const GpioPin* pin, GpioExtiCallback callback, void* context);
+void furi_hal_gpio_remove_int_callback(const GpioPin* pin);
+
+extern const GpioPin gpio_ext_pb2;
+extern const GpioPin gpio_ext_pc3;
+
+typedef struct {
+    const GpioPin* cs;
+} FuriHalSpiBusHandle;
+
+extern FuriHalSpiBusHandle furi_hal_spi_bus_handle_external;
+
+void furi_hal_spi_bus_handle_init(FuriHalSpiBusHandle* handle);
+void furi_hal_spi_bus_handle_deinit(FuriHalSpiBusHandle* handle);
+void furi_hal_spi_acquire(FuriHalSpiBusHandle* handle);
+void furi_hal_spi_release(FuriHalSpiBusHandle* handle);
+bool furi_hal_spi_bus_tx(
+    FuriHalSpiBusHandle* handle,
+    const uint8_t* buffer,
+    size_t size,
+    uint32_t timeout);
+bool furi_hal_spi_bus_rx(FuriHalSpiBusHandle* handle, uint8_t* buffer, size_t size, uint32_t timeout);
+
+typedef enum {
+    FuriHalRtcFlagHandOrient,
+} FuriHalRtcFlag;
+
+bool furi_hal_rtc_is_flag_set(FuriHalRtcFlag flag);
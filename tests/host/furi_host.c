@@ -0,0 +1,329 @@
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/* Host implementations behind tests/host, threads and thread flags on pthreads,
+ * storage on stdio under a directory standing in for the SD card. */
+
+#define FURI_HOST_STORAGE_ROOT "build/ext"
+#define FURI_HOST_PATH_MAX 512
+
+/* Log */
+
+void furi_log_print(char level, const char* tag, const char* format, ...) {
+    // debug lines are noise in test output
+    if(level == 'D' && !getenv("FURI_HOST_LOG_DEBUG")) return;
+
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "[%c][%s] ", level, tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "furi_crash: %s\n", message);
+    abort();
+}
+
+/* Time */
+
+uint32_t furi_get_tick(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000);
+}
+
+void furi_delay_us(uint32_t microseconds) {
+    struct timespec wait = {
+        .tv_sec = microseconds / 1000000,
+        .tv_nsec = (long)(microseconds % 1000000) * 1000,
+    };
+    while(nanosleep(&wait, &wait) != 0 && errno == EINTR) {
+    }
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    furi_delay_us(milliseconds * 1000);
+}
+
+void furi_delay_tick(uint32_t ticks) {
+    furi_delay_ms(ticks);
+}
+
+/* Threads */
+
+struct FuriThread {
+    pthread_t thread;
+    FuriThreadCallback callback;
+    void* context;
+    _Atomic FuriThreadState state;
+    bool started;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t signal;
+    uint32_t flags; // guarded by mutex
+};
+
+static _Thread_local FuriThread* furi_host_thread_current = NULL;
+
+static FuriThread* furi_host_thread_alloc(void) {
+    FuriThread* thread = malloc(sizeof(FuriThread));
+    memset(thread, 0, sizeof(FuriThread));
+    atomic_init(&thread->state, FuriThreadStateStopped);
+    pthread_mutex_init(&thread->mutex, NULL);
+    pthread_cond_init(&thread->signal, NULL);
+    return thread;
+}
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    UNUSED(name);
+    UNUSED(stack_size);
+    FuriThread* thread = furi_host_thread_alloc();
+    thread->callback = callback;
+    thread->context = context;
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    furi_check(atomic_load(&thread->state) == FuriThreadStateStopped);
+    pthread_cond_destroy(&thread->signal);
+    pthread_mutex_destroy(&thread->mutex);
+    free(thread);
+}
+
+static void* furi_host_thread_body(void* context) {
+    FuriThread* thread = context;
+    furi_host_thread_current = thread;
+    atomic_store(&thread->state, FuriThreadStateRunning);
+    thread->callback(thread->context);
+    atomic_store(&thread->state, FuriThreadStateStopped);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    atomic_store(&thread->state, FuriThreadStateStarting);
+    thread->started = true;
+    furi_check(pthread_create(&thread->thread, NULL, furi_host_thread_body, thread) == 0);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    if(thread->started) {
+        pthread_join(thread->thread, NULL);
+        thread->started = false;
+    }
+    return true;
+}
+
+FuriThreadState furi_thread_get_state(FuriThread* thread) {
+    return atomic_load(&thread->state);
+}
+
+FuriThreadId furi_thread_get_id(FuriThread* thread) {
+    return thread;
+}
+
+FuriThreadId furi_thread_get_current_id(void) {
+    // threads not started through furi, like main, get flags on first use
+    if(!furi_host_thread_current) {
+        furi_host_thread_current = furi_host_thread_alloc();
+    }
+    return furi_host_thread_current;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    FuriThread* thread = thread_id;
+    pthread_mutex_lock(&thread->mutex);
+    thread->flags |= flags;
+    uint32_t result = thread->flags;
+    pthread_cond_broadcast(&thread->signal);
+    pthread_mutex_unlock(&thread->mutex);
+    return result;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    FuriThread* thread = furi_thread_get_current_id();
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+    if(deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&thread->mutex);
+    uint32_t result;
+    while(true) {
+        uint32_t set = thread->flags & flags;
+        bool done = (options & FuriFlagWaitAll) ? set == flags : set != 0;
+        if(done) {
+            result = set;
+            if(!(options & FuriFlagNoClear)) {
+                thread->flags &= ~set;
+            }
+            break;
+        }
+        if(timeout == 0) {
+            result = (uint32_t)FuriFlagErrorTimeout;
+            break;
+        }
+        if(timeout == FuriWaitForever) {
+            pthread_cond_wait(&thread->signal, &thread->mutex);
+        } else if(pthread_cond_timedwait(&thread->signal, &thread->mutex, &deadline) == ETIMEDOUT) {
+            timeout = 0;
+        }
+    }
+    pthread_mutex_unlock(&thread->mutex);
+    return result;
+}
+
+/* Records */
+
+void* furi_record_open(const char* name) {
+    // only storage is asked for, and it has no state of its own
+    static int record;
+    UNUSED(name);
+    return &record;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+/* HAL */
+
+const GpioPin gpio_ext_pb2 = {.port = 1};
+const GpioPin gpio_ext_pc3 = {.port = 2};
+
+FuriHalSpiBusHandle furi_hal_spi_bus_handle_external = {.cs = NULL};
+
+void furi_hal_gpio_init(const GpioPin* pin, GpioMode mode, GpioPull pull, GpioSpeed speed) {
+    UNUSED(pin);
+    UNUSED(mode);
+    UNUSED(pull);
+    UNUSED(speed);
+}
+
+void furi_hal_gpio_add_int_callback(const GpioPin* pin, GpioExtiCallback callback, void* context) {
+    UNUSED(pin);
+    UNUSED(callback);
+    UNUSED(context);
+}
+
+void furi_hal_gpio_remove_int_callback(const GpioPin* pin) {
+    UNUSED(pin);
+}
+
+bool furi_hal_rtc_is_flag_set(FuriHalRtcFlag flag) {
+    UNUSED(flag);
+    return false;
+}
+
+/* Storage */
+
+struct File {
+    FILE* file;
+};
+
+static char furi_host_storage_root[FURI_HOST_PATH_MAX] = FURI_HOST_STORAGE_ROOT;
+
+void furi_host_storage_root_set(const char* root) {
+    snprintf(furi_host_storage_root, sizeof(furi_host_storage_root), "%s", root);
+}
+
+static void furi_host_storage_path(const char* path, char* host_path, size_t size) {
+    const char* prefix = "/ext";
+    if(strncmp(path, prefix, strlen(prefix)) == 0) {
+        snprintf(host_path, size, "%s%s", furi_host_storage_root, path + strlen(prefix));
+    } else {
+        snprintf(host_path, size, "%s", path);
+    }
+}
+
+static void furi_host_storage_mkdirs(const char* host_path) {
+    char directory[FURI_HOST_PATH_MAX];
+    snprintf(directory, sizeof(directory), "%s", host_path);
+    for(char* slash = strchr(directory + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(directory, 0755);
+        *slash = '/';
+    }
+}
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    File* file = malloc(sizeof(File));
+    file->file = NULL;
+    return file;
+}
+
+void storage_file_free(File* file) {
+    storage_file_close(file);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access, FS_OpenMode mode) {
+    char host_path[FURI_HOST_PATH_MAX];
+    furi_host_storage_path(path, host_path, sizeof(host_path));
+
+    const char* fopen_mode = "rb";
+    if(access & FSAM_WRITE) {
+        furi_host_storage_mkdirs(host_path);
+        if(mode & FSOM_OPEN_APPEND) {
+            fopen_mode = "ab";
+        } else if(mode & (FSOM_CREATE_ALWAYS | FSOM_CREATE_NEW)) {
+            fopen_mode = "wb";
+        } else {
+            fopen_mode = "r+b";
+        }
+    }
+
+    storage_file_close(file);
+    file->file = fopen(host_path, fopen_mode);
+    return file->file != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(file->file) {
+        fclose(file->file);
+        file->file = NULL;
+    }
+    return true;
+}
+
+bool storage_file_is_open(File* file) {
+    return file->file != NULL;
+}
+
+size_t storage_file_read(File* file, void* buffer, size_t size) {
+    return file->file ? fread(buffer, 1, size, file->file) : 0;
+}
+
+size_t storage_file_write(File* file, const void* buffer, size_t size) {
+    return file->file ? fwrite(buffer, 1, size, file->file) : 0;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    return file->file && fseek(file->file, offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    if(!file->file) return 0;
+    long position = ftell(file->file);
+    fseek(file->file, 0, SEEK_END);
+    long size = ftell(file->file);
+    fseek(file->file, position, SEEK_SET);
+    return size > 0 ? (uint64_t)size : 0;
+}
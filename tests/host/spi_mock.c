@@ -0,0 +1,146 @@
+#include "spi_mock.h"
+#include "sensors/ICM42688P/ICM42688P_regs.h"
+
+#define SPI_MOCK_FIFO_SIZE 2048
+#define SPI_MOCK_PACKET_SIZE 16
+#define SPI_MOCK_READ (1 << 7)
+#define SPI_MOCK_BANKS 5
+
+static struct {
+    uint8_t regs[SPI_MOCK_BANKS][128];
+    uint8_t bank; // REG_BANK_SEL, the same register in every bank
+    uint8_t fifo[SPI_MOCK_FIFO_SIZE];
+    size_t fifo_size;
+    size_t fifo_read;
+
+    bool acquired;
+    int16_t addr; // register of the running transaction, -1 before the command byte
+    bool reading;
+    uint32_t transactions;
+    size_t last_rx_size;
+} spi_mock;
+
+static uint8_t spi_mock_fifo_byte(void) {
+    if(spi_mock.fifo_read < spi_mock.fifo_size) {
+        return spi_mock.fifo[spi_mock.fifo_read++];
+    }
+
+    // past the end the chip sends packets with the empty flag in the header, the rest is junk
+    size_t offset = (spi_mock.fifo_read++ - spi_mock.fifo_size) % SPI_MOCK_PACKET_SIZE;
+    return offset == 0 ? 0x80 : 0xFF;
+}
+
+static uint16_t spi_mock_fifo_count(void) {
+    size_t left = spi_mock.fifo_read < spi_mock.fifo_size ? spi_mock.fifo_size - spi_mock.fifo_read : 0;
+    return left / SPI_MOCK_PACKET_SIZE;
+}
+
+void spi_mock_reset(void) {
+    memset(&spi_mock, 0, sizeof(spi_mock));
+    spi_mock.addr = -1;
+    spi_mock.regs[0][ICM42688_WHO_AM_I] = ICM42688_WHOAMI;
+}
+
+void spi_mock_fifo_push(const void* data, size_t size) {
+    furi_check(spi_mock.fifo_size + size <= SPI_MOCK_FIFO_SIZE);
+    memcpy(spi_mock.fifo + spi_mock.fifo_size, data, size);
+    spi_mock.fifo_size += size;
+}
+
+uint8_t spi_mock_reg_get(uint8_t addr) {
+    return spi_mock_bank_reg_get(0, addr);
+}
+
+void spi_mock_reg_set(uint8_t addr, uint8_t value) {
+    spi_mock.regs[0][addr & 0x7F] = value;
+}
+
+uint8_t spi_mock_bank_reg_get(uint8_t bank, uint8_t addr) {
+    furi_check(bank < SPI_MOCK_BANKS);
+    if((addr & 0x7F) == ICM42688_REG_BANK_SEL) return spi_mock.bank;
+    return spi_mock.regs[bank][addr & 0x7F];
+}
+
+uint8_t spi_mock_bank_get(void) {
+    return spi_mock.bank;
+}
+
+uint32_t spi_mock_transactions(void) {
+    return spi_mock.transactions;
+}
+
+size_t spi_mock_last_rx_size(void) {
+    return spi_mock.last_rx_size;
+}
+
+void furi_hal_spi_bus_handle_init(FuriHalSpiBusHandle* handle) {
+    UNUSED(handle);
+}
+
+void furi_hal_spi_bus_handle_deinit(FuriHalSpiBusHandle* handle) {
+    UNUSED(handle);
+}
+
+void furi_hal_spi_acquire(FuriHalSpiBusHandle* handle) {
+    UNUSED(handle);
+    furi_check(!spi_mock.acquired);
+    spi_mock.acquired = true;
+    spi_mock.addr = -1;
+    spi_mock.transactions++;
+}
+
+void furi_hal_spi_release(FuriHalSpiBusHandle* handle) {
+    UNUSED(handle);
+    furi_check(spi_mock.acquired);
+    spi_mock.acquired = false;
+}
+
+bool furi_hal_spi_bus_tx(
+    FuriHalSpiBusHandle* handle,
+    const uint8_t* buffer,
+    size_t size,
+    uint32_t timeout) {
+    UNUSED(handle);
+    UNUSED(timeout);
+    furi_check(spi_mock.acquired);
+
+    for(size_t i = 0; i < size; i++) {
+        if(spi_mock.addr < 0) {
+            spi_mock.addr = buffer[i] & 0x7F;
+            spi_mock.reading = buffer[i] & SPI_MOCK_READ;
+        } else {
+            // writes auto-increment like reads, the driver only ever writes one register
+            uint8_t addr = spi_mock.addr++ & 0x7F;
+            if(addr == ICM42688_REG_BANK_SEL) {
+                furi_check(buffer[i] < SPI_MOCK_BANKS);
+                spi_mock.bank = buffer[i];
+            } else {
+                spi_mock.regs[spi_mock.bank][addr] = buffer[i];
+            }
+        }
+    }
+    return true;
+}
+
+bool furi_hal_spi_bus_rx(FuriHalSpiBusHandle* handle, uint8_t* buffer, size_t size, uint32_t timeout) {
+    UNUSED(handle);
+    UNUSED(timeout);
+    furi_check(spi_mock.acquired && spi_mock.addr >= 0 && spi_mock.reading);
+
+    spi_mock.last_rx_size = size;
+    if(spi_mock.bank == 0 && spi_mock.addr == ICM42688_FIFO_DATA) {
+        // the address stays on the FIFO, every byte comes from it
+        for(size_t i = 0; i < size; i++) {
+            buffer[i] = spi_mock_fifo_byte();
+        }
+        return true;
+    }
+
+    uint16_t count = spi_mock_fifo_count();
+    spi_mock.regs[0][ICM42688_FIFO_COUNTH] = count & 0xFF; // little endian, set in init
+    spi_mock.regs[0][ICM42688_FIFO_COUNTH + 1] = count >> 8;
+    for(size_t i = 0; i < size; i++) {
+        buffer[i] = spi_mock_bank_reg_get(spi_mock.bank, spi_mock.addr++);
+    }
+    return true;
+}
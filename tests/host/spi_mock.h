@@ -0,0 +1,27 @@
+#pragma once
+#include <furi_hal.h>
+
+// SPI bus with an ICM42688P register file behind it, for tests of the real driver.
+// Reads of the FIFO data register stream the pushed bytes, then empty packets.
+// REG_BANK_SEL switches between the user banks 0 to 4, each with its own registers.
+
+void spi_mock_reset(void);
+
+// Queue bytes behind the FIFO data register, the FIFO count follows them in 16 byte packets
+void spi_mock_fifo_push(const void* data, size_t size);
+
+// Bank 0 register value as last written, or as set for reads
+uint8_t spi_mock_reg_get(uint8_t addr);
+
+void spi_mock_reg_set(uint8_t addr, uint8_t value);
+
+uint8_t spi_mock_bank_reg_get(uint8_t bank, uint8_t addr);
+
+// Bank selected now, what the next access goes to
+uint8_t spi_mock_bank_get(void);
+
+// Transactions, from acquire to release, since the reset
+uint32_t spi_mock_transactions(void);
+
+// Bytes received in the last rx call
+size_t spi_mock_last_rx_size(void);
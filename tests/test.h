@@ -0,0 +1,23 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+
+// Minimal checks for the host tests, a failing check is reported and fails the run
+
+static int test_failures = 0;
+
+#define TEST_CHECK(condition)                                                        \
+    do {                                                                             \
+        if(!(condition)) {                                                           \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition);            \
+            test_failures++;                                                         \
+        }                                                                            \
+    } while(0)
+
+#define TEST_RUN(test)           \
+    do {                         \
+        printf("%s\n", #test);   \
+        test();                  \
+    } while(0)
+
+#define TEST_EXIT() (test_failures ? (printf("%d checks failed\n", test_failures), 1) : 0)
@@ -0,0 +1,229 @@
+#include "test.h"
+#include "sensors/ICM42688P/ICM42688P.h"
+#include "sensors/ICM42688P/ICM42688P_regs.h"
+#include "spi_mock.h"
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define FIFO_HEADER_ACCEL_GYRO 0x68 // accel, gyro, 20 bit off, packet 3
+
+static FuriHalSpiBusHandle spi_bus;
+static const GpioPin irq_pin;
+
+static ICM42688P* fifo_setup(void) {
+    spi_mock_reset();
+    return icm42688p_alloc(&spi_bus, &irq_pin);
+}
+
+static ICM42688PFifoPacket fifo_packet(int16_t index) {
+    return (ICM42688PFifoPacket){
+        .header = FIFO_HEADER_ACCEL_GYRO,
+        .a_x = index,
+        .a_y = -index,
+        .a_z = 2048,
+        .g_x = (int16_t)(index * 3),
+        .temp = 20,
+        .ts = (uint16_t)(index * 1000),
+    };
+}
+
+static void fifo_fill(int16_t first, uint16_t count) {
+    for(uint16_t i = 0; i < count; i++) {
+        ICM42688PFifoPacket packet = fifo_packet(first + i);
+        spi_mock_fifo_push(&packet, sizeof(packet));
+    }
+}
+
+static void test_fifo_burst_counts_packets(void) {
+    ICM42688P* icm42688p = fifo_setup();
+    fifo_fill(1, 5);
+
+    ICM42688PFifoPacket data[8];
+    uint16_t read = icm42688_fifo_read_burst(icm42688p, data, 8);
+    TEST_CHECK(read == 5);
+    for(uint16_t i = 0; i < read; i++) {
+        ICM42688PFifoPacket expected = fifo_packet(1 + i);
+        TEST_CHECK(memcmp(&data[i], &expected, sizeof(expected)) == 0);
+    }
+
+    // the whole burst is one transaction, the FIFO data register streams every packet
+    TEST_CHECK(spi_mock_transactions() == 1);
+    TEST_CHECK(spi_mock_last_rx_size() == 8 * sizeof(ICM42688PFifoPacket));
+
+    icm42688p_free(icm42688p);
+}
+
+static void test_fifo_burst_full(void) {
+    ICM42688P* icm42688p = fifo_setup();
+    fifo_fill(1, 8);
+
+    ICM42688PFifoPacket data[8];
+    TEST_CHECK(icm42688_fifo_read_burst(icm42688p, data, 8) == 8);
+    ICM42688PFifoPacket last = fifo_packet(8);
+    TEST_CHECK(memcmp(&data[7], &last, sizeof(last)) == 0);
+
+    // what is left is read by the next burst
+    fifo_fill(9, 2);
+    TEST_CHECK(icm42688_fifo_read_burst(icm42688p, data, 8) == 2);
+    ICM42688PFifoPacket next = fifo_packet(9);
+    TEST_CHECK(memcmp(&data[0], &next, sizeof(next)) == 0);
+    TEST_CHECK(spi_mock_transactions() == 2);
+
+    icm42688p_free(icm42688p);
+}
+
+static void test_fifo_burst_empty_header_cutoff(void) {
+    ICM42688P* icm42688p = fifo_setup();
+
+    // counting stops at the first empty header, whatever follows it
+    fifo_fill(1, 2);
+    ICM42688PFifoPacket empty = fifo_packet(3);
+    empty.header = 0x80;
+    spi_mock_fifo_push(&empty, sizeof(empty));
+    fifo_fill(4, 2);
+
+    ICM42688PFifoPacket data[5];
+    TEST_CHECK(icm42688_fifo_read_burst(icm42688p, data, 5) == 2);
+
+    icm42688p_free(icm42688p);
+}
+
+static void test_fifo_burst_empty(void) {
+    ICM42688P* icm42688p = fifo_setup();
+
+    ICM42688PFifoPacket data[4];
+    TEST_CHECK(icm42688_fifo_read_burst(icm42688p, data, 4) == 0);
+    TEST_CHECK(spi_mock_transactions() == 1);
+
+    // nothing asked, nothing sent on the bus
+    TEST_CHECK(icm42688_fifo_read_burst(icm42688p, data, 0) == 0);
+    TEST_CHECK(spi_mock_transactions() == 1);
+
+    icm42688p_free(icm42688p);
+}
+
+static void test_fifo_count(void) {
+    ICM42688P* icm42688p = fifo_setup();
+    fifo_fill(1, 3);
+    TEST_CHECK(icm42688_fifo_get_count(icm42688p) == 3);
+
+    ICM42688PFifoPacket data[2];
+    icm42688_fifo_read_burst(icm42688p, data, 2);
+    TEST_CHECK(icm42688_fifo_get_count(icm42688p) == 1);
+
+    icm42688p_free(icm42688p);
+}
+
+// true if the call crashed, run in a child so the test carries on
+static bool watermark_set_crashes(uint16_t packets) {
+    pid_t pid = fork();
+    if(pid == 0) {
+        freopen("/dev/null", "w", stderr);
+        ICM42688P* icm42688p = fifo_setup();
+        icm42688_fifo_watermark_set(icm42688p, packets);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+static void test_fifo_watermark(void) {
+    ICM42688P* icm42688p = fifo_setup();
+
+    // in records, low byte in FIFO_CONFIG2 and the top bits in FIFO_CONFIG3
+    TEST_CHECK(icm42688_fifo_watermark_set(icm42688p, 100));
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG2) == 100);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG3) == 0);
+    TEST_CHECK(icm42688_fifo_watermark_get(icm42688p) == 100);
+
+    TEST_CHECK(icm42688_fifo_watermark_set(icm42688p, ICM42688P_FIFO_WATERMARK_MAX));
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG2) == (ICM42688P_FIFO_WATERMARK_MAX & 0xFF));
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG3) == ICM42688P_FIFO_WATERMARK_MAX >> 8);
+
+    // enabling the FIFO programs the watermark kept from before
+    icm42688_fifo_watermark_set(icm42688p, 7);
+    spi_mock_reset();
+    icm42688_fifo_enable(icm42688p, NULL, NULL);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG2) == 7);
+    icm42688_fifo_disable(icm42688p);
+
+    icm42688p_free(icm42688p);
+
+    // a watermark the FIFO cannot hold, or none at all, is a caller bug
+    TEST_CHECK(watermark_set_crashes(0));
+    TEST_CHECK(watermark_set_crashes(ICM42688P_FIFO_WATERMARK_MAX + 1));
+    TEST_CHECK(!watermark_set_crashes(1));
+}
+
+static void test_power_mode(void) {
+    ICM42688P* icm42688p = fifo_setup();
+
+    // PWR_MGMT0: temperature sensor on, gyro mode in bits 3:2, accel mode in bits 1:0
+    TEST_CHECK(icm42688p_power_mode_set(icm42688p, PowerModeLowNoise));
+    TEST_CHECK(spi_mock_reg_get(ICM42688_PWR_MGMT0) == 0x0F);
+    TEST_CHECK(icm42688p_power_mode_set(icm42688p, PowerModeLowPower));
+    TEST_CHECK(spi_mock_reg_get(ICM42688_PWR_MGMT0) == 0x0E);
+    TEST_CHECK(icm42688p_power_mode_set(icm42688p, PowerModeAccelOnly));
+    TEST_CHECK(spi_mock_reg_get(ICM42688_PWR_MGMT0) == 0x02);
+
+    icm42688p_free(icm42688p);
+}
+
+static void test_wom_enable(void) {
+    ICM42688P* icm42688p = fifo_setup();
+    // bank 0 registers at the addresses of the bank 4 thresholds
+    spi_mock_reg_set(ICM42688_SIGNAL_PATH_RESET, 0x11);
+    spi_mock_reg_set(ICM42688_INTF_CONFIG0, 0xC0);
+
+    TEST_CHECK(icm42688p_wom_enable(icm42688p, 13, NULL, NULL));
+    TEST_CHECK(spi_mock_bank_reg_get(4, ICM42688_ACCEL_WOM_X_THR) == 13);
+    TEST_CHECK(spi_mock_bank_reg_get(4, ICM42688_ACCEL_WOM_Y_THR) == 13);
+    TEST_CHECK(spi_mock_bank_reg_get(4, ICM42688_ACCEL_WOM_Z_THR) == 13);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_SIGNAL_PATH_RESET) == 0x11);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_INTF_CONFIG0) == 0xC0);
+
+    // back on bank 0 for every other access
+    TEST_CHECK(spi_mock_bank_get() == 0);
+    // IRQ1 on WOM x, y and z, WOM against the previous sample with any axis in SMD mode WOM
+    TEST_CHECK(spi_mock_reg_get(ICM42688_INT_SOURCE1) == 0x07);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_SMD_CONFIG) == 0x05);
+
+    icm42688p_wom_disable(icm42688p);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_INT_SOURCE1) == 0);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_SMD_CONFIG) == 0);
+    TEST_CHECK(spi_mock_bank_reg_get(4, ICM42688_ACCEL_WOM_X_THR) == 13);
+
+    icm42688p_free(icm42688p);
+}
+
+static void test_wom_triggered(void) {
+    ICM42688P* icm42688p = fifo_setup();
+
+    // INT_STATUS2 bits 0 to 2 are WOM on x, y and z
+    TEST_CHECK(!icm42688p_wom_triggered(icm42688p));
+    for(uint8_t axis = 0; axis < 3; axis++) {
+        spi_mock_reg_set(ICM42688_INT_STATUS2, 1 << axis);
+        TEST_CHECK(icm42688p_wom_triggered(icm42688p));
+    }
+
+    // significant motion alone is not a wake
+    spi_mock_reg_set(ICM42688_INT_STATUS2, 1 << 3);
+    TEST_CHECK(!icm42688p_wom_triggered(icm42688p));
+
+    icm42688p_free(icm42688p);
+}
+
+int main(void) {
+    TEST_RUN(test_fifo_burst_counts_packets);
+    TEST_RUN(test_fifo_burst_full);
+    TEST_RUN(test_fifo_burst_empty_header_cutoff);
+    TEST_RUN(test_fifo_burst_empty);
+    TEST_RUN(test_fifo_count);
+    TEST_RUN(test_fifo_watermark);
+    TEST_RUN(test_power_mode);
+    TEST_RUN(test_wom_enable);
+    TEST_RUN(test_wom_triggered);
+    return TEST_EXIT();
+}
@@ -0,0 +1,257 @@
+#include "test.h"
+// the pieces under test are static, so the file is built in
+#include "sensors/imu.c"
+#include "sensors/ICM42688P/ICM42688P_regs.h"
+#include "spi_mock.h"
+#include <pthread.h>
+
+#define SEQLOCK_WRITES 200000
+#define SEQLOCK_READERS 3
+
+#define BIAS_FULL_SCALE 2000.f // dps, the gyro range calibration runs at
+#define BIAS_LSB_DPS (BIAS_FULL_SCALE / 32768.f)
+
+typedef struct {
+    ImuSeqlock lock;
+    _Atomic bool writing;
+    _Atomic uint32_t torn;
+    _Atomic uint32_t backwards;
+    _Atomic uint32_t reads;
+} SeqlockStress;
+
+// every field follows from the generation, so a mix of two writes shows up as a mismatch
+static ImuOrientation seqlock_orientation(uint32_t generation) {
+    float value = (float)generation;
+    return (ImuOrientation){
+        .q0 = value,
+        .q1 = value * 2.f,
+        .q2 = -value,
+        .q3 = value + 0.5f,
+        .gx = value * 4.f,
+        .gy = value - 1.f,
+        .gz = -value * 2.f,
+        .timestamp = generation * 3,
+        .generation = generation,
+    };
+}
+
+static void* seqlock_writer(void* context) {
+    SeqlockStress* stress = context;
+    for(uint32_t generation = 1; generation <= SEQLOCK_WRITES; generation++) {
+        ImuOrientation orientation = seqlock_orientation(generation);
+        imu_seqlock_write(&stress->lock, &orientation);
+    }
+    atomic_store(&stress->writing, false);
+    return NULL;
+}
+
+static void* seqlock_reader(void* context) {
+    SeqlockStress* stress = context;
+    uint32_t last = 0;
+    uint32_t reads = 0;
+    while(atomic_load(&stress->writing)) {
+        ImuOrientation orientation;
+        imu_seqlock_read(&stress->lock, &orientation);
+
+        ImuOrientation expected = seqlock_orientation(orientation.generation);
+        if(memcmp(&orientation, &expected, sizeof(expected)) != 0) {
+            atomic_fetch_add(&stress->torn, 1);
+        }
+        if(orientation.generation < last) {
+            atomic_fetch_add(&stress->backwards, 1);
+        }
+        last = orientation.generation;
+        reads++;
+    }
+    atomic_fetch_add(&stress->reads, reads);
+    return NULL;
+}
+
+static void test_seqlock_stress(void) {
+    SeqlockStress stress;
+    memset(&stress, 0, sizeof(stress));
+    ImuOrientation initial = seqlock_orientation(0);
+    imu_seqlock_write(&stress.lock, &initial);
+    atomic_store(&stress.writing, true);
+
+    pthread_t readers[SEQLOCK_READERS];
+    for(size_t i = 0; i < SEQLOCK_READERS; i++) {
+        pthread_create(&readers[i], NULL, seqlock_reader, &stress);
+    }
+    pthread_t writer;
+    pthread_create(&writer, NULL, seqlock_writer, &stress);
+
+    pthread_join(writer, NULL);
+    for(size_t i = 0; i < SEQLOCK_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    TEST_CHECK(atomic_load(&stress.torn) == 0);
+    TEST_CHECK(atomic_load(&stress.backwards) == 0);
+    TEST_CHECK(atomic_load(&stress.reads) > 0);
+
+    ImuOrientation last;
+    imu_seqlock_read(&stress.lock, &last);
+    TEST_CHECK(last.generation == SEQLOCK_WRITES);
+}
+
+// a still gyro: a constant offset with a few LSB of noise
+static void bias_still(int16_t* values, int16_t offset) {
+    for(size_t i = 0; i < IMU_CALI_SAMPLES; i++) {
+        values[i] = offset + (int16_t)(i % 5) - 2;
+    }
+}
+
+static float bias_mean(const int16_t* values, size_t count) {
+    int32_t sum = 0;
+    for(size_t i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    return (float)sum / (float)count * BIAS_LSB_DPS;
+}
+
+static void test_gyro_bias_still(void) {
+    int16_t values[IMU_CALI_SAMPLES];
+    float expected;
+    float bias = 0.f;
+
+    bias_still(values, 100);
+    expected = bias_mean(values, IMU_CALI_SAMPLES);
+    TEST_CHECK(imu_gyro_axis_bias(values, IMU_CALI_SAMPLES, BIAS_FULL_SCALE, &bias));
+    TEST_CHECK(fabsf(bias - expected) < 1e-4f);
+
+    bias_still(values, -50);
+    expected = bias_mean(values, IMU_CALI_SAMPLES);
+    TEST_CHECK(imu_gyro_axis_bias(values, IMU_CALI_SAMPLES, BIAS_FULL_SCALE, &bias));
+    TEST_CHECK(fabsf(bias - expected) < 1e-4f);
+}
+
+static void test_gyro_bias_outliers(void) {
+    int16_t values[IMU_CALI_SAMPLES];
+    bias_still(values, 100);
+    float expected = bias_mean(values, IMU_CALI_SAMPLES - 4);
+
+    // a bump at the end of the burst is dropped, not averaged in
+    values[IMU_CALI_SAMPLES - 4] = 3000;
+    values[IMU_CALI_SAMPLES - 3] = -2500;
+    values[IMU_CALI_SAMPLES - 2] = 1200;
+    values[IMU_CALI_SAMPLES - 1] = INT16_MAX;
+
+    float bias = 0.f;
+    TEST_CHECK(imu_gyro_axis_bias(values, IMU_CALI_SAMPLES, BIAS_FULL_SCALE, &bias));
+    TEST_CHECK(fabsf(bias - expected) < 1e-4f);
+}
+
+static void test_gyro_bias_moving(void) {
+    int16_t values[IMU_CALI_SAMPLES];
+    float bias = 42.f;
+
+    // a slow turn, every sample is a little further along, about 8 dps end to end
+    for(size_t i = 0; i < IMU_CALI_SAMPLES; i++) {
+        values[i] = (int16_t)(i * 2);
+    }
+    TEST_CHECK(!imu_gyro_axis_bias(values, IMU_CALI_SAMPLES, BIAS_FULL_SCALE, &bias));
+
+    // set down halfway through, two steady rates 12 dps apart
+    for(size_t i = 0; i < IMU_CALI_SAMPLES; i++) {
+        values[i] = i < IMU_CALI_SAMPLES / 2 ? 0 : 200;
+    }
+    TEST_CHECK(!imu_gyro_axis_bias(values, IMU_CALI_SAMPLES, BIAS_FULL_SCALE, &bias));
+
+    // a rejected burst leaves the previous bias alone
+    TEST_CHECK(bias == 42.f);
+}
+
+static void test_predict_stale(void) {
+    static ImuThread thread;
+    memset(&thread, 0, sizeof(thread));
+    thread.latency_request = 10;
+    Imu imu = {.thread = &thread, .present = true};
+
+    // level and turning at 5 rad/s, 16 ms ahead is about 4.6 degrees of yaw
+    ImuOrientation orientation = {
+        .q0 = 1.f,
+        .gz = 5.f,
+        .timestamp = furi_get_tick(),
+        .generation = 1,
+    };
+    imu_seqlock_write(&thread.published, &orientation);
+
+    ImuEuler predicted;
+    ImuEuler current;
+    TEST_CHECK(imu_euler_predict(&imu, 16, &predicted) == orientation.timestamp);
+    imu_euler_get(&imu, &current);
+    TEST_CHECK(fabsf(predicted.yaw - current.yaw) > 3.f);
+
+    // a second old, the stream has stopped and the last rates say nothing about now
+    orientation.timestamp -= 1000;
+    orientation.generation = 2;
+    imu_seqlock_write(&thread.published, &orientation);
+    TEST_CHECK(imu_euler_predict(&imu, 16, &predicted) == orientation.timestamp);
+    imu_euler_get(&imu, &current);
+    TEST_CHECK(predicted.yaw == current.yaw);
+}
+
+static void test_idle_enter_exit(void) {
+    static FuriHalSpiBusHandle spi_bus;
+    static const GpioPin irq_pin;
+    static ImuThread thread;
+    memset(&thread, 0, sizeof(thread));
+    spi_mock_reset();
+    thread.icm42688p = icm42688p_alloc(&spi_bus, &irq_pin);
+    thread.rate = imu_rate_find(100);
+    thread.power = ImuPowerLowNoise;
+    thread.latency_ms = 40;
+
+    // streaming: FIFO on its watermark IRQ, gyro and accel low noise
+    imu_stream_start(&thread);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG) == 0x40);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_INT_SOURCE0) == 0x04);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG2) == 4);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_PWR_MGMT0) == 0x0F);
+
+    // asleep: FIFO bypassed, gyro off, a slow accel watched by wake-on-motion
+    imu_idle_enter(&thread);
+    TEST_CHECK(thread.idle && atomic_load(&thread.idle_state));
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG) == 0);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_INT_SOURCE0) == 0);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_PWR_MGMT0) == 0x02);
+    TEST_CHECK((spi_mock_reg_get(ICM42688_ACCEL_CONFIG0) & 0x0F) == ICM42688_AODR_25Hz);
+    TEST_CHECK(spi_mock_bank_reg_get(4, ICM42688_ACCEL_WOM_X_THR) == IMU_WOM_THRESHOLD);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_INT_SOURCE1) == 0x07);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_SMD_CONFIG) == 0x05);
+    TEST_CHECK(spi_mock_bank_get() == 0);
+
+    // new settings while asleep with auto idle still on are kept for the wake
+    atomic_store(&thread.rate_request, 200);
+    atomic_store(&thread.latency_request, 40);
+    atomic_store(&thread.auto_idle_request, true);
+    imu_config_apply(&thread);
+    TEST_CHECK(thread.idle);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_SMD_CONFIG) == 0x05);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG) == 0);
+
+    // auto idle off wakes the sensor, streaming at the new rate
+    atomic_store(&thread.auto_idle_request, false);
+    imu_config_apply(&thread);
+    TEST_CHECK(!thread.idle && !atomic_load(&thread.idle_state));
+    TEST_CHECK(spi_mock_reg_get(ICM42688_SMD_CONFIG) == 0);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_INT_SOURCE1) == 0);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG) == 0x40);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_INT_SOURCE0) == 0x04);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_FIFO_CONFIG2) == 8);
+    TEST_CHECK(spi_mock_reg_get(ICM42688_PWR_MGMT0) == 0x0F);
+    TEST_CHECK((spi_mock_reg_get(ICM42688_ACCEL_CONFIG0) & 0x0F) == ICM42688_AODR_200Hz);
+
+    icm42688p_free(thread.icm42688p);
+}
+
+int main(void) {
+    TEST_RUN(test_seqlock_stress);
+    TEST_RUN(test_gyro_bias_still);
+    TEST_RUN(test_gyro_bias_outliers);
+    TEST_RUN(test_gyro_bias_moving);
+    TEST_RUN(test_predict_stale);
+    TEST_RUN(test_idle_enter_exit);
+    return TEST_EXIT();
+}
@@ -0,0 +1,192 @@
+#include "test.h"
+#include "sensors/imu_gesture.h"
+#include <furi.h>
+
+// Synthetic 100 Hz sample streams, a device lying flat with gravity on z
+
+#define GESTURE_DT 0.01f
+
+typedef struct {
+    uint32_t counts[ImuGestureShake + 1];
+} GestureCounts;
+
+static ImuSample gesture_sample(float ax, float ay, float gz) {
+    return (ImuSample){
+        .ax = ax,
+        .ay = ay,
+        .az = 1.f,
+        .gz = gz,
+        .q0 = 1.f,
+        .dt = GESTURE_DT,
+    };
+}
+
+static void gesture_feed(ImuGesture* gesture, ImuSample sample, size_t count, GestureCounts* counts) {
+    for(size_t i = 0; i < count; i++) {
+        counts->counts[imu_gesture_feed(gesture, &sample)]++;
+    }
+}
+
+static void gesture_rest(ImuGesture* gesture, size_t count, GestureCounts* counts) {
+    gesture_feed(gesture, gesture_sample(0.f, 0.f, 0.f), count, counts);
+}
+
+static bool gesture_only(const GestureCounts* counts, ImuGestureType type, uint32_t count) {
+    for(size_t i = ImuGestureTap; i <= ImuGestureShake; i++) {
+        if(counts->counts[i] != (i == type ? count : 0)) return false;
+    }
+    return true;
+}
+
+// alternating strokes along x, a few samples each
+static void gesture_shake(ImuGesture* gesture, size_t strokes, GestureCounts* counts) {
+    for(size_t stroke = 0; stroke < strokes; stroke++) {
+        float ax = stroke % 2 ? -2.5f : 2.5f;
+        gesture_feed(gesture, gesture_sample(ax, 0.f, 0.f), 5, counts);
+    }
+}
+
+static void test_gesture_tap(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // a 30 ms knock, 3 g sideways with no rotation
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(3.f, 0.f, 0.f), 3, &counts);
+    gesture_rest(gesture, 50, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureTap, 1));
+
+    imu_gesture_free(gesture);
+}
+
+static void test_gesture_flick(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // 100 ms at 8 rad/s, then back to rest
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(0.f, 0.f, 8.f), 10, &counts);
+    gesture_rest(gesture, 50, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureFlick, 1));
+
+    imu_gesture_free(gesture);
+}
+
+static void test_gesture_slow_turn(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // steering, two seconds under the flick threshold
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(0.f, 0.f, 0.8f), 200, &counts);
+    gesture_rest(gesture, 50, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureNone, 0));
+
+    imu_gesture_free(gesture);
+}
+
+static void test_gesture_long_turn(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // as fast as a flick, but held for half a second
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(0.f, 0.f, 8.f), 50, &counts);
+    gesture_rest(gesture, 50, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureNone, 0));
+
+    imu_gesture_free(gesture);
+}
+
+static void test_gesture_push(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // as strong as a knock, but 200 ms long
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(2.f, 0.f, 0.f), 20, &counts);
+    gesture_rest(gesture, 100, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureNone, 0));
+
+    imu_gesture_free(gesture);
+}
+
+static void test_gesture_shake(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // every stroke is strong enough to start a tap, the shake must win
+    gesture_rest(gesture, 50, &counts);
+    gesture_shake(gesture, 4, &counts);
+    gesture_rest(gesture, 50, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureShake, 1));
+
+    imu_gesture_free(gesture);
+}
+
+static void test_gesture_shake_precedence(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // the wrist turns during the second stroke and stops on the third, a flick on its own that
+    // completes a stroke before the shake does
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(2.5f, 0.f, 0.f), 5, &counts);
+    gesture_feed(gesture, gesture_sample(-2.5f, 0.f, 8.f), 5, &counts);
+    gesture_feed(gesture, gesture_sample(2.5f, 0.f, 0.f), 5, &counts);
+    gesture_feed(gesture, gesture_sample(-2.5f, 0.f, 0.f), 5, &counts);
+    gesture_rest(gesture, 50, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureShake, 1));
+
+    imu_gesture_free(gesture);
+}
+
+static void test_gesture_holdoff(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // a second knock 100 ms after the first is the case still ringing
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(3.f, 0.f, 0.f), 3, &counts);
+    gesture_rest(gesture, 10, &counts);
+    gesture_feed(gesture, gesture_sample(3.f, 0.f, 0.f), 3, &counts);
+    gesture_rest(gesture, 10, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureTap, 1));
+
+    // once the hold-off is over the next one counts
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(3.f, 0.f, 0.f), 3, &counts);
+    gesture_rest(gesture, 50, &counts);
+    TEST_CHECK(gesture_only(&counts, ImuGestureTap, 2));
+
+    imu_gesture_free(gesture);
+}
+
+static void test_gesture_reset(void) {
+    ImuGesture* gesture = imu_gesture_alloc();
+    GestureCounts counts = {0};
+
+    // three strokes, a gap in the stream, then one more stroke is not a shake
+    gesture_rest(gesture, 50, &counts);
+    gesture_shake(gesture, 3, &counts);
+    imu_gesture_reset(gesture);
+    gesture_rest(gesture, 50, &counts);
+    gesture_feed(gesture, gesture_sample(-2.5f, 0.f, 0.f), 5, &counts);
+    gesture_rest(gesture, 50, &counts);
+    TEST_CHECK(counts.counts[ImuGestureShake] == 0);
+
+    imu_gesture_free(gesture);
+}
+
+int main(void) {
+    TEST_RUN(test_gesture_tap);
+    TEST_RUN(test_gesture_flick);
+    TEST_RUN(test_gesture_slow_turn);
+    TEST_RUN(test_gesture_long_turn);
+    TEST_RUN(test_gesture_push);
+    TEST_RUN(test_gesture_shake);
+    TEST_RUN(test_gesture_shake_precedence);
+    TEST_RUN(test_gesture_holdoff);
+    TEST_RUN(test_gesture_reset);
+    return TEST_EXIT();
+}
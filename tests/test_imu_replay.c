@@ -0,0 +1,133 @@
+#include "test.h"
+#include "sensors/imu.h"
+#include "sensors/ICM42688P/ICM42688P.h"
+#include <furi.h>
+#include <sys/stat.h>
+
+// The IMU pipeline end to end, sensor thread included, on a recording served by ICM42688P_replay.c
+
+#define REPLAY_DIR "build/replay"
+#define REPLAY_FILE REPLAY_DIR "/imu.bin"
+#define REPLAY_STORAGE REPLAY_DIR "/ext"
+#define REPLAY_CALIBRATION REPLAY_STORAGE "/apps_data/host/imu_gyro.cal"
+
+#define REPLAY_PACKETS 2064 // calibration burst and 2000 streamed
+#define REPLAY_WATERMARK 4 // 100 Hz at the default 40 ms latency
+#define REPLAY_SPEED "10" // 2 s for the whole recording
+#define REPLAY_QUIET_MS 500 // no sample for this long means the stream has been drained
+#define REPLAY_TIMEOUT_MS 10000
+
+#define REPLAY_ACCEL_LSB (16.f / 32768.f) // g per LSB at 16 g full scale
+
+// a still, level device at 100 Hz, the packet index rides in accel x and y a few LSB off level
+static ICM42688PFifoPacket replay_packet(uint16_t index) {
+    return (ICM42688PFifoPacket){
+        .header = 0x68,
+        .a_x = (int16_t)(index % 64) - 32,
+        .a_y = (int16_t)(index / 64) - 16,
+        .a_z = 2048,
+        .temp = 20,
+        .ts = (uint16_t)(index * 10000),
+    };
+}
+
+static void replay_write(const char* path, uint16_t count) {
+    mkdir("build", 0755);
+    mkdir(REPLAY_DIR, 0755);
+    FILE* file = fopen(path, "wb");
+    for(uint16_t i = 0; i < count; i++) {
+        ICM42688PFifoPacket packet = replay_packet(i);
+        fwrite(&packet, sizeof(packet), 1, file);
+    }
+    fclose(file);
+}
+
+static void test_replay_stream(void) {
+    replay_write(REPLAY_FILE, REPLAY_PACKETS);
+    setenv("ICM42688P_REPLAY_FILE", REPLAY_FILE, 1);
+    setenv("ICM42688P_REPLAY_SPEED", REPLAY_SPEED, 1);
+    furi_host_storage_root_set(REPLAY_STORAGE);
+    remove(REPLAY_CALIBRATION);
+
+    Imu* imu = imu_alloc();
+    TEST_CHECK(imu_present(imu));
+    imu_samples_enable(imu, true);
+
+    int32_t first = -1;
+    int32_t last = -1;
+    uint32_t popped = 0;
+    uint32_t gaps = 0;
+    uint32_t out_of_order = 0;
+    uint32_t bad_dt = 0;
+    uint32_t bad_accel = 0;
+    uint32_t start = furi_get_tick();
+    uint32_t last_tick = start;
+    while(furi_get_tick() - start < REPLAY_TIMEOUT_MS) {
+        ImuSample sample;
+        if(!imu_sample_pop(imu, &sample)) {
+            if(first >= 0 && furi_get_tick() - last_tick > REPLAY_QUIET_MS) break;
+            furi_delay_ms(1);
+            continue;
+        }
+        last_tick = furi_get_tick();
+
+        int32_t index = (int32_t)roundf(sample.ax / REPLAY_ACCEL_LSB) + 32 +
+                        64 * ((int32_t)roundf(sample.ay / REPLAY_ACCEL_LSB) + 16);
+        if(first < 0) {
+            first = index;
+        } else if(index <= last) {
+            out_of_order++;
+        } else {
+            gaps += index - last - 1;
+        }
+        last = index;
+        popped++;
+
+        if(fabsf(sample.dt - 0.01f) > 1e-4f) bad_dt++;
+        if(fabsf(sample.az - 1.f) > 1e-3f) bad_accel++;
+    }
+
+    TEST_CHECK(first >= 0);
+    TEST_CHECK(out_of_order == 0);
+    TEST_CHECK(bad_dt == 0);
+    TEST_CHECK(bad_accel == 0);
+
+    // every packet after the first sample was either popped or counted as dropped, up to the
+    // end of the recording less a tail shorter than the watermark, which never raises the IRQ
+    uint32_t dropped = imu_samples_dropped(imu);
+    uint32_t end = (uint32_t)first + popped + dropped;
+    TEST_CHECK(gaps <= dropped);
+    TEST_CHECK(end > REPLAY_PACKETS - REPLAY_WATERMARK && end <= REPLAY_PACKETS);
+
+    // level and still, the orientation stays put
+    ImuOrientation orientation;
+    imu_orientation_get(imu, &orientation);
+    TEST_CHECK(fabsf(orientation.q1) < 0.02f && fabsf(orientation.q2) < 0.02f);
+
+    // the sensor thread never writes to SD, the calibration is saved when the IMU is freed
+    FILE* early = fopen(REPLAY_CALIBRATION, "rb");
+    TEST_CHECK(early == NULL);
+    if(early) fclose(early);
+
+    imu_free(imu);
+
+    // the still start gives a calibration, kept for the next session
+    FILE* calibration = fopen(REPLAY_CALIBRATION, "rb");
+    TEST_CHECK(calibration != NULL);
+    if(calibration) fclose(calibration);
+}
+
+static void test_replay_missing(void) {
+    setenv("ICM42688P_REPLAY_FILE", REPLAY_DIR "/missing.bin", 1);
+
+    // no recording behaves like no sensor
+    Imu* imu = imu_alloc();
+    TEST_CHECK(!imu_present(imu));
+    imu_free(imu);
+}
+
+int main(void) {
+    TEST_RUN(test_replay_stream);
+    TEST_RUN(test_replay_missing);
+    return TEST_EXIT();
+}
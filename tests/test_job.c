@@ -0,0 +1,94 @@
+#include "test.h"
+#include "job.h"
+#include <stdatomic.h>
+#include <time.h>
+
+#define JOB_WORKERS 3
+
+static void job_count(void* context) {
+    atomic_fetch_add((_Atomic uint32_t*)context, 1);
+}
+
+static void job_range_sum(size_t start, size_t end, void* context) {
+    uint64_t sum = 0;
+    for(size_t i = start; i < end; i++) {
+        sum += i;
+    }
+    atomic_fetch_add((_Atomic uint64_t*)context, sum);
+}
+
+static double job_cpu_seconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+static void test_job_submit_wait(void) {
+    JobSystem* system = job_system_alloc(JOB_WORKERS);
+    TEST_CHECK(job_system_workers_get(system) == JOB_WORKERS);
+
+    // more jobs than a queue holds, the overflow runs inline
+    _Atomic uint32_t count = 0;
+    JobGroup group = {0};
+    for(uint32_t i = 0; i < 1000; i++) {
+        job_submit(system, &group, job_count, &count);
+    }
+    job_wait(system, &group);
+    TEST_CHECK(atomic_load(&count) == 1000);
+    TEST_CHECK(atomic_load(&group.pending) == 0);
+
+    job_system_free(system);
+}
+
+static void test_job_parallel_for(void) {
+    JobSystem* system = job_system_alloc(JOB_WORKERS);
+
+    _Atomic uint64_t sum = 0;
+    job_parallel_for(system, 100000, 0, job_range_sum, &sum);
+    TEST_CHECK(atomic_load(&sum) == 100000ull * 99999ull / 2);
+
+    job_system_free(system);
+}
+
+static void test_job_inline(void) {
+    JobSystem* system = job_system_alloc(0);
+
+    _Atomic uint32_t count = 0;
+    JobGroup group = {0};
+    job_submit(system, &group, job_count, &count);
+    TEST_CHECK(atomic_load(&count) == 1); // ran before submit returned
+    job_wait(system, &group);
+
+    job_system_free(system);
+}
+
+static void test_job_idle_workers_sleep(void) {
+    JobSystem* system = job_system_alloc(JOB_WORKERS);
+
+    // many small rounds give workers every chance to pop a job right as it is pushed
+    for(int round = 0; round < 2000; round++) {
+        _Atomic uint32_t count = 0;
+        JobGroup group = {0};
+        for(int i = 0; i < 4; i++) {
+            job_submit(system, &group, job_count, &count);
+        }
+        job_wait(system, &group);
+    }
+
+    // with nothing queued the workers wait on the condition, they must not spin
+    double cpu_start = job_cpu_seconds();
+    struct timespec idle = {.tv_sec = 0, .tv_nsec = 200 * 1000 * 1000};
+    nanosleep(&idle, NULL);
+    double cpu_idle = job_cpu_seconds() - cpu_start;
+    TEST_CHECK(cpu_idle < 0.05);
+
+    job_system_free(system);
+}
+
+int main(void) {
+    TEST_RUN(test_job_submit_wait);
+    TEST_RUN(test_job_parallel_for);
+    TEST_RUN(test_job_inline);
+    TEST_RUN(test_job_idle_workers_sleep);
+    return TEST_EXIT();
+}